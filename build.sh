@@ -8,7 +8,7 @@ build_dir="output"
 flags="-std=c++20 -Wall -Wextra -pedantic -Isrc "
 flags+="$(pkg-config --cflags fmt)"
 
-link_libs="$(pkg-config --libs --static fmt)"
+link_libs="-pthread $(pkg-config --libs --static fmt)"
 
 object_files=""
 
@@ -45,6 +45,21 @@ function cmd_build {
 	compile_source main.cpp
 	compile_source property/property.cpp
 	compile_source property/type_id.cpp
+	compile_source property/pool.cpp
+	compile_source property/journal.cpp
+	compile_source property/hash.cpp
+	compile_source property/schema.cpp
+	compile_source property/serialize.cpp
+	compile_source property/blend.cpp
+	compile_source property/parse.cpp
+	compile_source property/memory_report.cpp
+	compile_source property/projection.cpp
+	compile_source property/sort.cpp
+	compile_source property/filter.cpp
+	compile_source property/layout.cpp
+	compile_source property/packed.cpp
+	compile_source property/loader.cpp
+	compile_source property/snapshot.cpp
 	link $object_files -ooutput/build
 }
 
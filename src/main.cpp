@@ -1,6 +1,21 @@
 #include "property/util.h"
 #include "property/property.h"
 #include "property/registration.h"
+#include "property/pool.h"
+#include "property/journal.h"
+#include "property/hash.h"
+#include "property/schema.h"
+#include "property/serialize.h"
+#include "property/blend.h"
+#include "property/parse.h"
+#include "property/memory_report.h"
+#include "property/projection.h"
+#include "property/sort.h"
+#include "property/filter.h"
+#include "property/layout.h"
+#include "property/packed.h"
+#include "property/loader.h"
+#include "property/snapshot.h"
 
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -8,6 +23,8 @@
 #include <cstdint>
 #include <memory>
 #include <algorithm>
+#include <filesystem>
+#include <fstream>
 
 
 
@@ -26,6 +43,39 @@ struct Foo {
 	std::vector<int> list;
 };
 
+// A reordered subset of Foo, e.g., for saving
+struct FooSummary {
+	int a_field;
+	Blah blah;
+	std::string whatever;
+	float not_in_foo;
+};
+
+// Declared in an order that wastes space
+struct Padded {
+	float a;
+	std::string name;
+	int b;
+	Blah blah;
+	float c;
+};
+
+// A tree, whose children are instances of the same struct
+struct Node {
+	int value;
+	std::vector<Node> children;
+};
+
+// Not registered, so it can't be compared or serialized
+struct Label {
+	std::string text;
+};
+
+struct Labelled {
+	int id;
+	Label label;
+};
+
 
 std::string format_debug(Foo const& foo) {
 	return fmt::format(
@@ -43,6 +93,13 @@ std::string format_debug(Blah const& blah) {
 	);
 };
 
+std::string format_debug(Label const& label) {
+	return fmt::format(
+		"Label<text: '{}'>",
+		label.text
+	);
+};
+
 std::string format_debug(Wamp wamp) {
 	switch (wamp) {
 		case Wamp::A: return "Wamp::A";
@@ -153,5 +210,457 @@ int main() {
 	} else {
 		fmt::print("no :(\n");
 	}
-}
 
+
+	fmt::print("\n--- pool ---\n");
+
+	property::StructPools pools {kernel};
+
+	auto pooled_foo = pools.create<Foo>();
+	pooled_foo->a_field = 5;
+	pooled_foo->whatever = "pooled";
+	pools.pool_for(kernel.get_struct_id<Foo>())->reset_to_default(reinterpret_cast<std::byte*>(pooled_foo));
+	fmt::print("reset_to_default: {}\n", *pooled_foo);
+
+	for (int i = 0; i < 100; i++) {
+		pools.create<Blah>()->meh = float(i);
+	}
+
+	auto const blah_pool = pools.pool_for(kernel.get_struct_id<Blah>());
+	fmt::print("Blah pool: {} live, {} capacity\n", blah_pool->size(), blah_pool->capacity());
+
+	pools.clear();
+	fmt::print("after clear: {} live\n", blah_pool->size());
+
+
+	fmt::print("\n--- journal ---\n");
+
+	property::Journal journal {kernel};
+	auto const foo_mut_ref = property::type_erase_struct_mut(kernel, &foo);
+	auto const resolve_foo = [&] (property::InstanceId, property::StructId) {
+		return reinterpret_cast<std::byte*>(&foo);
+	};
+
+	journal.begin_transaction();
+	journal.write(1, foo_mut_ref, "a_field", 4);
+	journal.write(1, foo_mut_ref, "a_field", 6);
+	journal.write(1, foo_mut_ref, "a_blah/meh", 2.5f);
+	journal.write(1, foo_mut_ref, "whatever", std::string{"journaled"});
+	journal.commit_transaction();
+
+	fmt::print("after write: {} ({} bytes of history)\n", foo, journal.arena_size());
+	journal.undo(resolve_foo);
+	fmt::print("after undo: {}\n", foo);
+	journal.redo(resolve_foo);
+	fmt::print("after redo: {}\n", foo);
+
+
+	fmt::print("\n--- hash ---\n");
+
+	auto const foo_hash_plan = property::make_hash_plan(kernel, *kernel.struct_def_for<Foo>());
+	Foo foo_copy = foo;
+
+	fmt::print("hash(foo) == hash(foo_copy): {}\n", foo_hash_plan.hash(reinterpret_cast<std::byte const*>(&foo)) == *property::hash(kernel, property::type_erase_struct(kernel, &foo_copy)));
+	foo_copy.list.push_back(4);
+	fmt::print("equal after list push: {}\n", *property::equal(kernel, foo_ref, property::type_erase_struct(kernel, &foo_copy)));
+
+
+	fmt::print("\n--- schema migration ---\n");
+
+	// Blah as it was saved by an older version, with meh stored as an int after a since removed field
+	struct OldBlah { int removed; int meh; };
+
+	property::Kernel old_kernel {};
+	auto struct_old_blah = register_struct<OldBlah>(old_kernel, "Blah");
+	struct_old_blah.add_field(&OldBlah::removed, "removed", "Removed", "");
+	struct_old_blah.add_field(&OldBlah::meh, "meh", "Meh", "");
+
+	OldBlah const old_blahs[] {{1, 10}, {2, 20}, {3, 30}};
+	auto const saved_old_blahs = *property::serialize(old_kernel, *old_kernel.struct_def_for<OldBlah>(), reinterpret_cast<std::byte const*>(old_blahs), 3);
+
+	auto const blah_def = kernel.struct_def_for<Blah>();
+	auto const old_blah_buffer = *property::SerializedBuffer::open(saved_old_blahs);
+	auto const migration = property::make_migration_plan(kernel, *old_blah_buffer.schema(), *blah_def);
+
+	Blah migrated_blahs[3];
+	for (std::size_t idx = 0; idx < 3; idx++) {
+		property::migrate_record(migration, old_blah_buffer, idx, reinterpret_cast<std::byte*>(&migrated_blahs[idx]));
+	}
+
+	fmt::print("fingerprint: {:x}, saved with {:x}\n", property::schema_fingerprint(kernel, *blah_def), old_blah_buffer.header.fingerprint);
+	fmt::print("migrated: {}, {}, {} (dropped {})\n", migrated_blahs[0], migrated_blahs[1], migrated_blahs[2], migration.dropped_fields.size());
+
+
+	fmt::print("\n--- serialized views ---\n");
+
+	Foo const foos_to_save[] {
+		foo,
+		Foo {"second", -2, Blah{1.5f}, Wamp::C, std::vector{4, 5}},
+	};
+
+	auto const foo_def = kernel.struct_def_for<Foo>();
+	auto const serialized_foos = *property::serialize(kernel, *foo_def, reinterpret_cast<std::byte const*>(foos_to_save), 2);
+
+	if (auto serialized = property::SerializedBuffer::open(serialized_foos); serialized && serialized->matches(kernel, *foo_def)) {
+		auto const record = *serialized->record(foo_def, 1);
+		inspect(kernel, record);
+
+		if (auto meh = resolve_field_path(kernel, record, "a_blah/meh")) {
+			fmt::print("serialized try_read<float>(): {}\n", *meh->try_read<float>());
+		}
+
+		if (auto list = resolve_field_path(kernel, record, "list")->try_read_list<int>()) {
+			fmt::print("serialized list: [{}]\n", fmt::join(*list, ", "));
+		}
+	}
+
+	// Records are read in place, so a copy at an unaligned offset is rejected rather than misread
+	std::vector<std::byte> shifted_foos(serialized_foos.size() + 1);
+	std::copy(serialized_foos.begin(), serialized_foos.end(), shifted_foos.begin() + 1);
+	fmt::print("unaligned copy opens: {}\n", property::SerializedBuffer::open(std::span{shifted_foos}.subspan(1)).has_value());
+
+
+	fmt::print("\n--- attribute index ---\n");
+
+	for (auto [struct_id, field_idx] : kernel.fields_with_attribute<HiddenAttribute>()) {
+		auto const struct_def = kernel.struct_def_for(struct_id);
+		fmt::print("{}::{} is hidden\n", struct_def->name, struct_def->fields[field_idx].name);
+	}
+	fmt::print("Foo contains hidden fields: {}\n", kernel.struct_contains_attribute<HiddenAttribute>(foo_def->id));
+
+	property::for_each_field_with_attribute<RangeAttribute<float>>(kernel, foo_ref, [] (property::FieldRef field_ref) {
+		fmt::print("{} has a float range, value {}\n", field_ref.field_def->name, *field_ref.try_read<float>());
+	});
+
+
+	fmt::print("\n--- blend ---\n");
+
+	auto const foo_blend_plan = property::make_blend_plan<RangeAttribute>(kernel, *foo_def, {.blend_ints = true});
+
+	for (float t : {0.0f, 0.25f, 0.75f, 1.0f}) {
+		Foo blended;
+		foo_blend_plan.blend(reinterpret_cast<std::byte const*>(&foos_to_save[0]), reinterpret_cast<std::byte const*>(&foos_to_save[1]),
+			t, reinterpret_cast<std::byte*>(&blended));
+		fmt::print("t = {}: {}\n", t, blended);
+	}
+
+
+	fmt::print("\n--- parse ---\n");
+
+	constexpr std::string_view foo_records_text =
+		"# some foos\n"
+		"whatever = \"loaded\"\n"
+		"a_field = 3\n"
+		"a_blah = {meh = 1.25}\n"
+		"womp = Wamp::C\n"
+		"list = [7, 8, 9]\n"
+		"\n"
+		"a_field = -1\n"
+		"a_blah/meh = 3.5\n"
+		"not_a_field = 1\n";
+
+	Foo loaded_foos[2];
+	auto const load_result = property::load_records(kernel, property::type_erase_span_mut<Foo>(kernel, loaded_foos), foo_records_text);
+
+	fmt::print("loaded {} records, {} errors (first on line {})\n", load_result.record_count, load_result.error_count,
+		load_result.first_error_line.value_or(0));
+	fmt::print("{}, list: [{}]\n", loaded_foos[0], fmt::join(loaded_foos[0].list, ", "));
+	fmt::print("{}\n", loaded_foos[1]);
+
+	auto const womp_ref = *resolve_field_path(kernel, property::type_erase_struct_mut(kernel, &loaded_foos[1]), "womp");
+	fmt::print("womp accepts Wamp::B: {}, Blah::B: {}, 2: {}, 300: {}\n", parse_field(kernel, womp_ref, "Wamp::B"),
+		parse_field(kernel, womp_ref, "Blah::B"), parse_field(kernel, womp_ref, "2"), parse_field(kernel, womp_ref, "300"));
+
+
+	fmt::print("\n--- estimated memory usage ---\n");
+
+	auto const memory_report = kernel.estimate_memory_usage();
+	fmt::print("{}", memory_report);
+
+#ifdef __GLIBCXX__
+	// Regression check of the estimate for the schema registered above. The figures follow the libstdc++ layout the
+	// estimate assumes, so they catch changes to what's counted rather than tracking the real heap footprint
+	struct ExpectedUsage {
+		std::string_view category;
+		property::MemoryUsage actual;
+		property::MemoryUsage expected;
+	};
+
+	ExpectedUsage const expected_usages[] {
+		{"structs", memory_report.structs, {1024, 3}},
+		{"fields", memory_report.fields, {2160, 2}},
+		{"strings", memory_report.strings, {59, 3}},
+		{"attributes", memory_report.attributes, {88, 5}},
+		{"enums", memory_report.enums, {680, 4}},
+		{"lookup maps", memory_report.lookup_maps, {504, 12}},
+		{"other", memory_report.other, {172, 8}},
+		{"total", memory_report.total(), {4687, 37}},
+	};
+
+	for (auto const& [category, actual, expected] : expected_usages) {
+		if (actual.bytes != expected.bytes || actual.allocations != expected.allocations) {
+			fmt::print("memory estimate changed for {}: {} bytes in {} allocations, expected {} bytes in {} allocations\n",
+				category, actual.bytes, actual.allocations, expected.bytes, expected.allocations);
+			return 1;
+		}
+	}
+#endif
+
+
+	fmt::print("\n--- projection ---\n");
+
+	auto struct_foo_summary = register_struct<FooSummary>(kernel, "FooSummary");
+	struct_foo_summary.add_field(&FooSummary::a_field, "a_field", "A Field", "");
+	struct_foo_summary.add_field(&FooSummary::blah, "a_blah", "The Blah", "");
+	struct_foo_summary.add_field(&FooSummary::whatever, "whatever", "Whatever", "");
+	struct_foo_summary.add_field(&FooSummary::not_in_foo, "not_in_foo", "Not In Foo", "");
+
+	auto const summary_projection = property::make_projection(kernel, *foo_def, *kernel.struct_def_for<FooSummary>());
+	fmt::print("{} copy ranges, {} assigned fields, unmatched: [{}]\n", summary_projection.copies.size(),
+		summary_projection.assigns.size(), fmt::join(summary_projection.unmatched_fields, ", "));
+
+	FooSummary summaries[2] {};
+	summary_projection.apply(property::type_erase_span<Foo>(kernel, foos_to_save), property::type_erase_span_mut<FooSummary>(kernel, summaries));
+
+	for (auto const& summary : summaries) {
+		fmt::print("FooSummary<a_field: {}, blah: {}, whatever: '{}', not_in_foo: {}>\n", summary.a_field, summary.blah,
+			summary.whatever, summary.not_in_foo);
+	}
+
+
+	fmt::print("\n--- sort ---\n");
+
+	std::vector<Foo> foos_to_sort {
+		Foo {"delta", 4, Blah{0.5f}, Wamp::B, {}},
+		Foo {"alpha", -7, Blah{2.5f}, Wamp::C, {}},
+		Foo {"charlie", 4, Blah{-1.0f}, Wamp::A, {}},
+		Foo {"bravo", 0, Blah{1.0f}, Wamp::A, {}},
+	};
+
+	auto const foos_span = property::type_erase_span<Foo>(kernel, foos_to_sort);
+
+	for (auto const path : {"a_field", "a_blah/meh", "womp", "whatever"}) {
+		auto const permutation = property::sort_by_field(kernel, foos_span, path);
+		fmt::print("by {}: [{}]\n", path, fmt::join(*permutation, ", "));
+	}
+
+	fmt::print("by whatever, descending: [{}]\n",
+		fmt::join(*property::sort_by_field(kernel, foos_span, "whatever", property::SortOrder::Descending), ", "));
+
+	property::SortedFieldIndex a_field_index {*property::make_field_sort_key(kernel, foo_def, "a_field")};
+	a_field_index.build(foos_span);
+
+	foos_to_sort[3].a_field = 10;
+	a_field_index.update(3, reinterpret_cast<std::byte const*>(&foos_to_sort[3]));
+	foos_to_sort.push_back(Foo {"echo", 1, Blah{0.0f}, Wamp::B, {}});
+	a_field_index.append(reinterpret_cast<std::byte const*>(&foos_to_sort.back()));
+
+	fmt::print("index by a_field: [{}], in [0, 5]: [{}]\n", fmt::join(a_field_index.sorted(), ", "),
+		fmt::join(a_field_index.int_range(0, 5), ", "));
+
+
+	fmt::print("\n--- filter ---\n");
+
+	auto const all_foos = property::type_erase_span<Foo>(kernel, foos_to_sort);
+
+	for (auto const expression : {
+		"a_field > 0 && a_blah/meh < 2.0",
+		"womp == B || !(whatever < \"c\")",
+		"a_field >= 4 && (womp == Wamp::A || womp == C)",
+		"a_blah/meh > 1 && womp == D",
+		"list == 3",
+	}) {
+		auto const compiled = property::compile_filter(kernel, foo_def, expression);
+		if (!compiled.plan) {
+			fmt::print("{}: error at {}: {}\n", expression, compiled.error_offset, compiled.error);
+			continue;
+		}
+
+		auto const bitmap = compiled.plan->select_bitmap(all_foos);
+		fmt::print("{}: [{}] (bitmap {:b})\n", expression, fmt::join(compiled.plan->select_indices(all_foos), ", "), bitmap[0]);
+	}
+
+
+	fmt::print("\n--- layout ---\n");
+
+	auto struct_padded = register_struct<Padded>(kernel, "Padded");
+	struct_padded.add_field(&Padded::a, "a", "A", "");
+	struct_padded.add_field(&Padded::name, "name", "Name", "");
+	struct_padded.add_field(&Padded::b, "b", "B", "");
+	struct_padded.add_field(&Padded::blah, "blah", "Blah", "");
+	struct_padded.add_field(&Padded::c, "c", "C", "");
+
+	std::uint64_t const padded_access_counts[] {0, 10, 5000, 0, 4000};
+	auto const layout_report = property::analyze_layout(kernel, *kernel.struct_def_for<Padded>(), {
+		.instance_count = 1'000'000,
+		.access_counts = padded_access_counts,
+	});
+	fmt::print("{}", layout_report);
+
+
+	fmt::print("\n--- packed ---\n");
+
+	auto const foo_packed_layout = property::make_packed_layout<RangeAttribute>(kernel, *foo_def);
+	fmt::print("{} bits per Foo (vs {} bytes), skipped: [{}]\n", foo_packed_layout.bits_per_instance(), foo_def->size,
+		fmt::join(foo_packed_layout.skipped_fields, ", "));
+
+	property::PackedStructArray packed_foos {foo_packed_layout};
+	packed_foos.pack(property::type_erase_span<Foo>(kernel, foos_to_sort));
+
+	auto const packed_meh = *packed_foos.field(kernel, "a_blah/meh");
+	packed_foos.try_set(packed_meh, 0, 3.0f);
+	fmt::print("{} packed in {} bytes, meh of #0: {}\n", packed_foos.size(), packed_foos.memory_bytes(),
+		*packed_foos.try_get<float>(packed_meh, 0));
+
+	std::vector<Foo> unpacked_foos(packed_foos.size());
+	packed_foos.unpack(property::type_erase_span_mut<Foo>(kernel, unpacked_foos));
+
+	for (auto const& unpacked_foo : unpacked_foos) {
+		fmt::print("{}, womp: {}\n", unpacked_foo, unpacked_foo.womp);
+	}
+
+
+	fmt::print("\n--- loader ---\n");
+
+	auto const level_directory = std::filesystem::temp_directory_path() / "property_loader_demo";
+	std::filesystem::create_directories(level_directory);
+
+	auto const write_level_file = [&level_directory] (std::string const& name, std::span<std::byte const> data) {
+		auto const path = (level_directory / name).string();
+		std::ofstream {path, std::ios::binary}.write(reinterpret_cast<char const*>(data.data()), std::streamsize(data.size()));
+		return path;
+	};
+
+	std::vector<std::string> level_paths;
+	for (int file_idx = 0; file_idx < 8; file_idx++) {
+		auto const foos = *property::serialize(kernel, *foo_def, reinterpret_cast<std::byte const*>(foos_to_sort.data()), foos_to_sort.size());
+		level_paths.push_back(write_level_file(fmt::format("foos_{}.bin", file_idx), foos));
+	}
+
+	Blah const level_blahs[] {Blah{1.0f}, Blah{2.0f}, Blah{3.0f}};
+	level_paths.push_back(write_level_file("blahs.bin", *property::serialize(kernel, *blah_def, reinterpret_cast<std::byte const*>(level_blahs), 3)));
+	level_paths.push_back(write_level_file("old_blahs.bin", saved_old_blahs));
+	level_paths.push_back(write_level_file("garbage.bin", std::as_bytes(std::span{"not a serialized buffer"})));
+	level_paths.push_back((level_directory / "missing.bin").string());
+
+	property::StructPools level_pools {kernel};
+	auto const level_load_result = property::load_files(kernel, level_pools, level_paths, {.max_buffered_bytes = 1024});
+
+	fmt::print("{} files, {} failed, {} Foos and {} Blahs in pools\n", level_load_result.files.size(), level_load_result.failed_files,
+		level_pools.pool_for(foo_def->id)->size(), level_pools.pool_for(blah_def->id)->size());
+	fmt::print("first loaded Foo: {}\n", *reinterpret_cast<Foo const*>(level_load_result.files[0].instances[0]));
+
+	auto const& old_blahs_file = level_load_result.files[9];
+	fmt::print("{} migrated: {}, first Blah: {}\n", std::filesystem::path{old_blahs_file.path}.filename().string(), old_blahs_file.migrated,
+		old_blahs_file.instances.empty() ? Blah{} : *reinterpret_cast<Blah const*>(old_blahs_file.instances[0]));
+	fmt::print("{}", level_load_result.stats);
+
+	// A file larger than the budget is still read whole, so that's the most the loader may buffer
+	std::size_t largest_level_file = 0;
+	for (auto const& path : level_paths) {
+		std::error_code error;
+		if (auto const size = std::filesystem::file_size(path, error); !error) {
+			largest_level_file = std::max<std::size_t>(largest_level_file, size);
+		}
+	}
+
+	std::filesystem::remove_all(level_directory);
+
+	auto const level_foo_count = level_pools.pool_for(foo_def->id)->size();
+	auto const level_blah_count = level_pools.pool_for(blah_def->id)->size();
+	auto const level_buffer_limit = std::max<std::size_t>(1024, largest_level_file);
+	if (level_foo_count != 40 || level_blah_count != 6 || level_load_result.failed_files != 2 || !old_blahs_file.migrated
+		|| level_load_result.stats.peak_buffered_bytes > level_buffer_limit)
+	{
+		fmt::print("loader mismatch: {} Foos, {} Blahs and {} failed files, expected 40, 6 and 2; old Blahs migrated: {}; peak buffered {} bytes, limit {}\n",
+			level_foo_count, level_blah_count, level_load_result.failed_files, old_blahs_file.migrated,
+			level_load_result.stats.peak_buffered_bytes, level_buffer_limit);
+		return 1;
+	}
+
+
+	fmt::print("\n--- snapshots ---\n");
+
+	auto versioned = *property::VersionedObject::create(kernel, property::type_erase_struct(kernel, &foos_to_save[1]));
+	std::vector<property::Snapshot> versions {versioned.snapshot()};
+
+	versioned.resolve_field_path("a_blah/meh")->try_write(2.0f);
+	versions.push_back(versioned.snapshot());
+
+	versioned.resolve_field_path("list")->try_get<std::vector<int>>()->push_back(99);
+	versions.push_back(versioned.snapshot());
+
+	for (std::size_t version = 0; version < versions.size(); version++) {
+		Foo materialized;
+		versions[version].materialize(reinterpret_cast<std::byte*>(&materialized));
+		fmt::print("v{}: meh: {}, {}, list: [{}]\n", version, *resolve_field_path(kernel, versions[version], "a_blah/meh")->try_read<float>(),
+			materialized, fmt::join(materialized.list, ", "));
+	}
+
+	auto const snapshots_usage = property::memory_usage(versions);
+	fmt::print("{} versions in {} bytes, {} allocations\n", versions.size(), snapshots_usage.bytes, snapshots_usage.allocations);
+
+	// Each version should only add the nodes on its write's path: the root and Blah nodes for v1, and the root
+	// and list nodes for v2. Struct nodes are three allocations (node, data, children) and list nodes two
+	auto const field_ptr_in = [&] (std::size_t version, std::string_view path) {
+		return resolve_field_path(kernel, versions[version], path)->field_ptr;
+	};
+
+	auto const v0_usage = property::memory_usage(std::span{versions}.first(1));
+	auto const v1_usage = property::memory_usage(std::span{versions}.first(2));
+
+	// A bad path fails before anything is copied, so the head still shares the last snapshot's root
+	bool const bad_path_resolved = versioned.resolve_field_path("a_blah/not_a_field").has_value();
+
+	bool const shares_untouched = !bad_path_resolved && versioned.snapshot().root == versions.back().root
+		&& field_ptr_in(0, "list") == field_ptr_in(1, "list")
+		&& field_ptr_in(1, "a_blah/meh") == field_ptr_in(2, "a_blah/meh")
+		&& field_ptr_in(0, "a_blah/meh") != field_ptr_in(1, "a_blah/meh");
+	bool const grows_with_change = v1_usage.allocations - v0_usage.allocations == 6
+		&& snapshots_usage.allocations - v1_usage.allocations == 5
+		&& v1_usage.bytes - v0_usage.bytes < v0_usage.bytes
+		&& snapshots_usage.bytes - v1_usage.bytes < v0_usage.bytes;
+
+	if (!shares_untouched || !grows_with_change) {
+		fmt::print("snapshots don't share untouched nodes: v0 {} bytes, v0..v1 {} bytes, v0..v2 {} bytes\n",
+			v0_usage.bytes, v1_usage.bytes, snapshots_usage.bytes);
+		return 1;
+	}
+
+
+	fmt::print("\n--- recursive lists ---\n");
+
+	auto struct_node = register_struct<Node>(kernel, "Node");
+	struct_node.add_field(&Node::value, "value", "Value", "");
+	struct_node.add_field(&Node::children, "children", "Children", "");
+
+	auto struct_labelled = register_struct<Labelled>(kernel, "Labelled");
+	struct_labelled.add_field(&Labelled::id, "id", "Id", "");
+	struct_labelled.add_field(&Labelled::label, "label", "Label", "");
+
+	Node const tree {1, {Node{2, {Node{3, {}}}}, Node{4, {}}}};
+	Node changed_tree = tree;
+	changed_tree.children[0].children[0].value = 5;
+
+	auto const node_def = kernel.struct_def_for<Node>();
+	auto const serialized_tree = *property::serialize(kernel, *node_def, reinterpret_cast<std::byte const*>(&tree), 1);
+	Node loaded_tree;
+	bool const tree_loaded = property::deserialize(kernel, *property::SerializedBuffer::open(serialized_tree),
+		property::StructMutSpan{node_def, reinterpret_cast<std::byte*>(&loaded_tree), 1});
+
+	auto const tree_ref = property::type_erase_struct(kernel, &tree);
+	auto const changed_equal = property::equal(kernel, tree_ref, property::type_erase_struct(kernel, &changed_tree));
+	auto const loaded_equal = property::equal(kernel, tree_ref, property::type_erase_struct(kernel, &loaded_tree));
+
+	Labelled const labelled[] {{1, Label{"first"}}, {1, Label{"second"}}};
+	auto const labelled_equal = property::equal(kernel, property::type_erase_struct(kernel, &labelled[0]), property::type_erase_struct(kernel, &labelled[1]));
+	auto const serialized_labelled = property::serialize(kernel, *kernel.struct_def_for<Labelled>(), reinterpret_cast<std::byte const*>(labelled), 2);
+
+	fmt::print("equal after deep change: {}, equal after round trip: {}, Labelled comparable: {}, serializable: {}\n",
+		*changed_equal, tree_loaded && loaded_equal == true, labelled_equal.has_value(), serialized_labelled.has_value());
+
+	if (changed_equal != false || !tree_loaded || loaded_equal != true || labelled_equal || serialized_labelled) {
+		fmt::print("recursive or unsupported fields were ignored\n");
+		return 1;
+	}
+}
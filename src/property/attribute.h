@@ -24,6 +24,8 @@ namespace property {
 
 			virtual ~AttributeBase() {}
 			virtual std::string format() const = 0;
+			// Size of the most derived object, for memory accounting
+			virtual std::size_t allocation_size() const = 0;
 		};
 
 		template<class A>
@@ -38,6 +40,10 @@ namespace property {
 			std::string format() const final {
 				return format_debug(attribute);
 			}
+
+			std::size_t allocation_size() const final {
+				return sizeof(AttributeImpl);
+			}
 		};
 	}
 
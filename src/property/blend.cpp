@@ -0,0 +1,276 @@
+#include "property/blend.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace property {
+
+	namespace {
+		constexpr std::size_t blend_block_size = 64;
+		// Plans with at most this many float and int fields blend single instances without allocating
+		constexpr std::size_t inline_field_count = 64;
+
+		void collect_blend_fields(Kernel const& kernel, StructDef const& struct_def, std::uint32_t base_offset,
+			BlendOptions options, internal::BlendRangeFn range_fn, BlendPlan& plan)
+		{
+			constexpr auto infinity = std::numeric_limits<double>::infinity();
+
+			for (auto const& field_def : struct_def.fields) {
+				auto const& field_info = field_def.field_info;
+				auto const offset = base_offset + static_cast<std::uint32_t>(field_info.offset);
+
+				if (auto struct_id = kernel.struct_id_from_type_id(field_info.type_id)) {
+					collect_blend_fields(kernel, *kernel.struct_def_for(*struct_id), offset, options, range_fn, plan);
+					continue;
+				}
+
+				bool const is_float = field_info.type_id == TypeId::Float;
+				bool const is_int = options.blend_ints && field_info.type_id == TypeId::Int;
+				if (!is_float && !is_int) {
+					continue;
+				}
+
+				auto const range = range_fn ? range_fn(field_def) : std::nullopt;
+				BlendPlan::BlendField const field {
+					offset,
+					range ? range->first : -infinity,
+					range ? range->second : infinity,
+				};
+
+				if (is_float) {
+					plan.float_fields.push_back(field);
+				} else {
+					plan.int_fields.push_back(field);
+				}
+			}
+		}
+
+
+		void collect_copy_fields(Kernel const& kernel, StructDef const& struct_def, std::uint32_t base_offset,
+			std::string const& prefix, BlendPlan& plan)
+		{
+			for (auto const& field_def : struct_def.fields) {
+				auto const& field_info = field_def.field_info;
+				auto const offset = base_offset + static_cast<std::uint32_t>(field_info.offset);
+
+				if (auto struct_id = kernel.struct_id_from_type_id(field_info.type_id)) {
+					auto const& nested_def = *kernel.struct_def_for(*struct_id);
+					if (!nested_def.lifecycle.trivially_copyable && !nested_def.lifecycle.copy_assign) {
+						collect_copy_fields(kernel, nested_def, offset, prefix + field_def.name + "/", plan);
+						continue;
+					}
+				}
+
+				if (field_info.copy_assignable) {
+					plan.copy_fields.push_back({offset, &field_info});
+				} else {
+					plan.uncopyable_fields.push_back(prefix + field_def.name);
+				}
+			}
+		}
+
+
+		void copy_struct(BlendPlan const& plan, std::byte* dst, std::byte const* src) {
+			if (dst == src) {
+				return;
+			}
+
+			auto const& struct_def = *plan.struct_def;
+
+			if (struct_def.lifecycle.trivially_copyable) {
+				std::memcpy(dst, src, struct_def.size);
+			} else if (struct_def.lifecycle.copy_assign) {
+				struct_def.lifecycle.copy_assign(dst, src);
+			} else {
+				for (auto const& [offset, field_info] : plan.copy_fields) {
+					field_info->copy_assign(dst + offset, src + offset);
+				}
+			}
+		}
+
+
+		template<class T>
+		void gather_column(T* column, std::byte const* data, std::size_t stride, std::uint32_t offset, std::size_t count) {
+			for (std::size_t idx = 0; idx < count; idx++) {
+				std::memcpy(&column[idx], data + idx * stride + offset, sizeof(T));
+			}
+		}
+
+
+		template<class T>
+		void scatter_column(T const* column, std::byte* data, std::size_t stride, std::uint32_t offset, std::size_t count) {
+			for (std::size_t idx = 0; idx < count; idx++) {
+				std::memcpy(data + idx * stride + offset, &column[idx], sizeof(T));
+			}
+		}
+
+
+		float lerp_float(float a, float b, float t, float min, float max) {
+			auto const value = a + (b - a) * t;
+			return std::min(std::max(value, min), max);
+		}
+
+
+		int lerp_int(int a, int b, float t, double min, double max) {
+			auto const value = std::round(a + (double(b) - a) * t);
+			return static_cast<int>(std::min(std::max(value, min), max));
+		}
+
+
+		void lerp_float_column(float* __restrict a, float const* __restrict b, float t, float min, float max, std::size_t count) {
+			for (std::size_t idx = 0; idx < count; idx++) {
+				a[idx] = lerp_float(a[idx], b[idx], t, min, max);
+			}
+		}
+
+
+		void lerp_int_column(int* __restrict a, int const* __restrict b, float t, double min, double max, std::size_t count) {
+			for (std::size_t idx = 0; idx < count; idx++) {
+				a[idx] = lerp_int(a[idx], b[idx], t, min, max);
+			}
+		}
+
+
+		template<class T>
+		T read_field(std::byte const* struct_ptr, std::uint32_t offset) {
+			T value;
+			std::memcpy(&value, struct_ptr + offset, sizeof value);
+			return value;
+		}
+	}
+
+
+	auto internal::make_blend_plan(Kernel const& kernel, StructDef const& struct_def, BlendOptions options,
+		BlendRangeFn range_fn) -> BlendPlan
+	{
+		BlendPlan plan {&struct_def, {}, {}, {}, {}};
+		collect_blend_fields(kernel, struct_def, 0, options, range_fn, plan);
+
+		if (!struct_def.lifecycle.trivially_copyable && !struct_def.lifecycle.copy_assign) {
+			collect_copy_fields(kernel, struct_def, 0, "", plan);
+		}
+
+		return plan;
+	}
+
+
+	auto make_blend_plan(Kernel const& kernel, StructDef const& struct_def, BlendOptions options) -> BlendPlan {
+		return internal::make_blend_plan(kernel, struct_def, options, nullptr);
+	}
+
+
+
+	void BlendPlan::blend(std::byte const* a, std::byte const* b, float t, std::byte* out) const {
+		auto const float_count = this->float_fields.size();
+		auto const int_count = this->int_fields.size();
+
+		if (float_count > inline_field_count || int_count > inline_field_count) {
+			this->blend(
+				StructSpan{this->struct_def, a, 1},
+				StructSpan{this->struct_def, b, 1},
+				t,
+				StructMutSpan{this->struct_def, out, 1}
+			);
+			return;
+		}
+
+		// Blend everything before writing to out, since out may alias a or b
+		std::array<float, inline_field_count> floats;
+		std::array<int, inline_field_count> ints;
+
+		for (std::size_t field = 0; field < float_count; field++) {
+			auto const& [offset, min, max] = this->float_fields[field];
+			floats[field] = lerp_float(read_field<float>(a, offset), read_field<float>(b, offset), t,
+				static_cast<float>(min), static_cast<float>(max));
+		}
+
+		for (std::size_t field = 0; field < int_count; field++) {
+			auto const& [offset, min, max] = this->int_fields[field];
+			ints[field] = lerp_int(read_field<int>(a, offset), read_field<int>(b, offset), t, min, max);
+		}
+
+		copy_struct(*this, out, (t < 0.5f) ? a : b);
+
+		for (std::size_t field = 0; field < float_count; field++) {
+			std::memcpy(out + this->float_fields[field].offset, &floats[field], sizeof(float));
+		}
+
+		for (std::size_t field = 0; field < int_count; field++) {
+			std::memcpy(out + this->int_fields[field].offset, &ints[field], sizeof(int));
+		}
+	}
+
+
+	void BlendPlan::blend(StructSpan a, StructSpan b, float t, StructMutSpan out) const {
+		auto const count = std::min({a.count, b.count, out.count});
+		auto const stride = this->struct_def->size;
+		auto const nearer = (t < 0.5f) ? a : b;
+
+		auto const float_count = this->float_fields.size();
+		auto const int_count = this->int_fields.size();
+
+		std::vector<float> float_columns_a(float_count * blend_block_size);
+		std::vector<float> float_columns_b(float_count * blend_block_size);
+		std::vector<int> int_columns_a(int_count * blend_block_size);
+		std::vector<int> int_columns_b(int_count * blend_block_size);
+
+		for (std::size_t block_begin = 0; block_begin < count; block_begin += blend_block_size) {
+			auto const block_size = std::min(blend_block_size, count - block_begin);
+			auto const a_ptr = a.data + block_begin * stride;
+			auto const b_ptr = b.data + block_begin * stride;
+			auto const nearer_ptr = nearer.data + block_begin * stride;
+			auto const out_ptr = out.data + block_begin * stride;
+
+			// Gather everything before writing to out, since out may alias a or b
+			for (std::size_t field = 0; field < float_count; field++) {
+				auto const offset = this->float_fields[field].offset;
+				gather_column(&float_columns_a[field * blend_block_size], a_ptr, stride, offset, block_size);
+				gather_column(&float_columns_b[field * blend_block_size], b_ptr, stride, offset, block_size);
+			}
+
+			for (std::size_t field = 0; field < int_count; field++) {
+				auto const offset = this->int_fields[field].offset;
+				gather_column(&int_columns_a[field * blend_block_size], a_ptr, stride, offset, block_size);
+				gather_column(&int_columns_b[field * blend_block_size], b_ptr, stride, offset, block_size);
+			}
+
+			for (std::size_t idx = 0; idx < block_size; idx++) {
+				copy_struct(*this, out_ptr + idx * stride, nearer_ptr + idx * stride);
+			}
+
+			for (std::size_t field = 0; field < float_count; field++) {
+				auto const& blend_field = this->float_fields[field];
+				auto const column_a = &float_columns_a[field * blend_block_size];
+
+				lerp_float_column(
+					column_a, &float_columns_b[field * blend_block_size], t,
+					static_cast<float>(blend_field.min), static_cast<float>(blend_field.max), block_size
+				);
+
+				scatter_column(column_a, out_ptr, stride, blend_field.offset, block_size);
+			}
+
+			for (std::size_t field = 0; field < int_count; field++) {
+				auto const& blend_field = this->int_fields[field];
+				auto const column_a = &int_columns_a[field * blend_block_size];
+
+				lerp_int_column(
+					column_a, &int_columns_b[field * blend_block_size], t,
+					blend_field.min, blend_field.max, block_size
+				);
+
+				scatter_column(column_a, out_ptr, stride, blend_field.offset, block_size);
+			}
+		}
+	}
+
+
+
+	void blend(Kernel const& kernel, StructDef const& struct_def, std::byte const* a, std::byte const* b, float t, std::byte* out) {
+		make_blend_plan(kernel, struct_def).blend(a, b, t, out);
+	}
+
+}
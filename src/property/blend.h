@@ -0,0 +1,73 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace property {
+
+	struct BlendOptions {
+		// Also interpolate int fields, rounding to the nearest value
+		bool blend_ints = false;
+	};
+
+
+	// Precomputed interpolation between two instances of a registered struct.
+	// Every float field, including those in nested structs, is linearly interpolated and clamped to
+	// its range if it has one. All other fields are copied from whichever keyframe is nearer to t.
+	struct BlendPlan {
+		struct BlendField {
+			std::uint32_t offset;
+			double min;
+			double max;
+		};
+
+		struct CopyField {
+			std::uint32_t offset;
+			FieldTypeInfo const* field_info;
+		};
+
+		StructDef const* struct_def;
+		std::vector<BlendField> float_fields;
+		std::vector<BlendField> int_fields;
+
+		// Structs that aren't copy assignable as a whole are copied field by field, splitting nested structs
+		// that aren't copy assignable either. Empty for copy assignable structs
+		std::vector<CopyField> copy_fields;
+		// Paths of fields that can't be copied at all, so keep whatever out held
+		std::vector<std::string> uncopyable_fields;
+
+		// out may alias a or b. Doesn't allocate unless the plan has over 64 float or int fields
+		void blend(std::byte const* a, std::byte const* b, float t, std::byte* out) const;
+
+		// Blends a[i] and b[i] into out[i]. Instances are processed in blocks, with each field gathered
+		// into a contiguous column so that interpolation runs as a simple vectorisable loop
+		void blend(StructSpan a, StructSpan b, float t, StructMutSpan out) const;
+	};
+
+
+	namespace internal {
+		using BlendRangeFn = std::optional<std::pair<double, double>> (*)(FieldDef const&);
+
+		auto make_blend_plan(Kernel const&, StructDef const&, BlendOptions, BlendRangeFn) -> BlendPlan;
+	}
+
+	auto make_blend_plan(Kernel const& kernel, StructDef const& struct_def, BlendOptions options = {}) -> BlendPlan;
+
+	// Clamps blended fields to the bounds of Range<float>/Range<int> attributes, e.g., make_blend_plan<RangeAttribute>(...).
+	// Range<T> must have min and max members
+	template<template<class> class Range>
+	auto make_blend_plan(Kernel const& kernel, StructDef const& struct_def, BlendOptions options = {}) -> BlendPlan;
+
+
+	// Convenience wrapper that builds a BlendPlan per call, without clamping
+	void blend(Kernel const& kernel, StructDef const& struct_def, std::byte const* a, std::byte const* b, float t, std::byte* out);
+
+} // property
+
+
+#include "property/blend.inl"
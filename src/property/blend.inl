@@ -0,0 +1,20 @@
+namespace property {
+
+	template<template<class> class Range>
+	auto make_blend_plan(Kernel const& kernel, StructDef const& struct_def, BlendOptions options) -> BlendPlan {
+		auto const range_fn = [] (FieldDef const& field_def) -> std::optional<std::pair<double, double>> {
+			if (auto range = field_def.attributes.get_attribute<Range<float>>()) {
+				return std::pair{double(range->min), double(range->max)};
+			}
+
+			if (auto range = field_def.attributes.get_attribute<Range<int>>()) {
+				return std::pair{double(range->min), double(range->max)};
+			}
+
+			return std::nullopt;
+		};
+
+		return internal::make_blend_plan(kernel, struct_def, options, range_fn);
+	}
+
+} // property
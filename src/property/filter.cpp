@@ -0,0 +1,466 @@
+#include "property/filter.h"
+#include "property/internal/value_access.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fmt/format.h>
+
+namespace property {
+
+	namespace {
+		constexpr std::size_t filter_batch_size = 256;
+
+		using CompareOp = FilterPlan::CompareOp;
+		using Comparison = FilterPlan::Comparison;
+
+
+		struct Token {
+			enum class Kind {
+				Identifier,
+				Number,
+				String,
+				Compare,
+				And,
+				Or,
+				Not,
+				OpenParen,
+				CloseParen,
+				End,
+				Invalid,
+			};
+
+			Kind kind;
+			std::string_view text;
+			std::size_t offset;
+			CompareOp compare_op;
+		};
+
+
+		bool is_identifier_start(char c) {
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+		}
+
+		bool is_digit(char c) {
+			return c >= '0' && c <= '9';
+		}
+
+
+		auto lex(std::string_view text, std::size_t offset) -> Token {
+			while (offset < text.size() && (text[offset] == ' ' || text[offset] == '\t' || text[offset] == '\r' || text[offset] == '\n')) {
+				offset++;
+			}
+
+			auto const make_token = [&text, offset] (Token::Kind kind, std::size_t length, CompareOp op = CompareOp::Equal) {
+				return Token{kind, text.substr(offset, length), offset, op};
+			};
+
+			if (offset == text.size()) {
+				return make_token(Token::Kind::End, 0);
+			}
+
+			auto const rest = text.substr(offset);
+			auto const c = rest.front();
+
+			if (rest.starts_with("&&")) return make_token(Token::Kind::And, 2);
+			if (rest.starts_with("||")) return make_token(Token::Kind::Or, 2);
+			if (rest.starts_with("==")) return make_token(Token::Kind::Compare, 2, CompareOp::Equal);
+			if (rest.starts_with("!=")) return make_token(Token::Kind::Compare, 2, CompareOp::NotEqual);
+			if (rest.starts_with("<=")) return make_token(Token::Kind::Compare, 2, CompareOp::LessEqual);
+			if (rest.starts_with(">=")) return make_token(Token::Kind::Compare, 2, CompareOp::GreaterEqual);
+			if (c == '<') return make_token(Token::Kind::Compare, 1, CompareOp::Less);
+			if (c == '>') return make_token(Token::Kind::Compare, 1, CompareOp::Greater);
+			if (c == '!') return make_token(Token::Kind::Not, 1);
+			if (c == '(') return make_token(Token::Kind::OpenParen, 1);
+			if (c == ')') return make_token(Token::Kind::CloseParen, 1);
+
+			if (c == '"') {
+				auto const close = rest.find('"', 1);
+				if (close == std::string_view::npos) {
+					return make_token(Token::Kind::Invalid, rest.size());
+				}
+				return make_token(Token::Kind::String, close + 1);
+			}
+
+			if (is_identifier_start(c)) {
+				std::size_t length = 1;
+				while (length < rest.size() && (is_identifier_start(rest[length]) || is_digit(rest[length]) || rest[length] == '/' || rest[length] == ':')) {
+					length++;
+				}
+				return make_token(Token::Kind::Identifier, length);
+			}
+
+			if (is_digit(c) || c == '-' || c == '+' || c == '.') {
+				std::size_t length = 1;
+				while (length < rest.size()) {
+					auto const n = rest[length];
+					bool const is_exponent_sign = (n == '+' || n == '-') && (rest[length - 1] == 'e' || rest[length - 1] == 'E');
+					if (!is_digit(n) && n != '.' && n != 'e' && n != 'E' && !is_exponent_sign) {
+						break;
+					}
+					length++;
+				}
+				return make_token(Token::Kind::Number, length);
+			}
+
+			return make_token(Token::Kind::Invalid, 1);
+		}
+
+
+		// Recursive descent parser emitting the plan's ops in postfix order:
+		//
+		//     or         = and ("||" and)*
+		//     and        = unary ("&&" unary)*
+		//     unary      = "!" unary | "(" or ")" | comparison
+		//     comparison = path compare_op literal
+		struct FilterParser {
+			Kernel const& kernel;
+			std::string_view text;
+			FilterPlan& plan;
+
+			Token token;
+			std::string error;
+			std::size_t error_offset = 0;
+			std::size_t stack_depth = 0;
+
+			void advance() {
+				this->token = lex(this->text, this->token.offset + this->token.text.size());
+			}
+
+			bool fail(std::string message) {
+				if (this->error.empty()) {
+					this->error = std::move(message);
+					this->error_offset = this->token.offset;
+				}
+				return false;
+			}
+
+			void emit(FilterPlan::OpKind kind, std::uint32_t comparison_idx = 0) {
+				switch (kind) {
+					case FilterPlan::OpKind::Compare: this->stack_depth++; break;
+					case FilterPlan::OpKind::And: case FilterPlan::OpKind::Or: this->stack_depth--; break;
+					case FilterPlan::OpKind::Not: break;
+				}
+
+				this->plan.max_stack_depth = std::max(this->plan.max_stack_depth, this->stack_depth);
+				this->plan.ops.push_back({kind, comparison_idx});
+			}
+
+
+			bool parse_or() {
+				if (!this->parse_and()) {
+					return false;
+				}
+
+				while (this->token.kind == Token::Kind::Or) {
+					this->advance();
+					if (!this->parse_and()) {
+						return false;
+					}
+					this->emit(FilterPlan::OpKind::Or);
+				}
+
+				return true;
+			}
+
+			bool parse_and() {
+				if (!this->parse_unary()) {
+					return false;
+				}
+
+				while (this->token.kind == Token::Kind::And) {
+					this->advance();
+					if (!this->parse_unary()) {
+						return false;
+					}
+					this->emit(FilterPlan::OpKind::And);
+				}
+
+				return true;
+			}
+
+			bool parse_unary() {
+				if (this->token.kind == Token::Kind::Not) {
+					this->advance();
+					if (!this->parse_unary()) {
+						return false;
+					}
+					this->emit(FilterPlan::OpKind::Not);
+					return true;
+				}
+
+				if (this->token.kind == Token::Kind::OpenParen) {
+					this->advance();
+					if (!this->parse_or()) {
+						return false;
+					}
+					if (this->token.kind != Token::Kind::CloseParen) {
+						return this->fail("expected ')'");
+					}
+					this->advance();
+					return true;
+				}
+
+				return this->parse_comparison();
+			}
+
+			bool parse_comparison() {
+				if (this->token.kind != Token::Kind::Identifier) {
+					return this->fail("expected a field path");
+				}
+
+				auto const path = this->token.text;
+				auto const compiled_path = compile_field_path(this->kernel, this->plan.struct_def, path);
+				if (!compiled_path) {
+					return this->fail(fmt::format("unknown field \"{}\"", path));
+				}
+
+				auto const field_def = compiled_path->field_def;
+				if (field_def->list_info) {
+					return this->fail(fmt::format("can't compare list field \"{}\"", path));
+				}
+
+				Comparison comparison {
+					static_cast<std::uint32_t>(compiled_path->offset),
+					static_cast<std::uint32_t>(field_def->field_info.size),
+					Comparison::Kind::Int,
+					CompareOp::Equal,
+					0,
+					0.0,
+					{},
+				};
+
+				this->advance();
+				if (this->token.kind != Token::Kind::Compare) {
+					return this->fail("expected a comparison operator");
+				}
+				comparison.op = this->token.compare_op;
+
+				this->advance();
+				if (!this->parse_literal(field_def->field_info.type_id, comparison)) {
+					return false;
+				}
+				this->advance();
+
+				auto const comparison_idx = static_cast<std::uint32_t>(this->plan.comparisons.size());
+				this->plan.comparisons.push_back(std::move(comparison));
+				this->emit(FilterPlan::OpKind::Compare, comparison_idx);
+				return true;
+			}
+
+			bool parse_literal(TypeId type_id, Comparison& comparison) {
+				auto const literal = this->token.text;
+				auto const kind = this->token.kind;
+
+				switch (type_id) {
+					case TypeId::Int: {
+						comparison.kind = Comparison::Kind::Int;
+						if (kind != Token::Kind::Number || !internal::parse_number(literal, comparison.int_value)) {
+							return this->fail("expected an integer");
+						}
+						return true;
+					}
+
+					case TypeId::Float: {
+						comparison.kind = Comparison::Kind::Float;
+						if (kind != Token::Kind::Number || !internal::parse_number(literal, comparison.float_value)) {
+							return this->fail("expected a number");
+						}
+						return true;
+					}
+
+					case TypeId::String: {
+						comparison.kind = Comparison::Kind::String;
+						if (kind == Token::Kind::String) {
+							comparison.string_value = literal.substr(1, literal.size() - 2);
+						} else if (kind == Token::Kind::Identifier) {
+							comparison.string_value = literal;
+						} else {
+							return this->fail("expected a string");
+						}
+						return true;
+					}
+
+					default: break;
+				}
+
+				auto const enum_id = this->kernel.enum_id_from_type_id(type_id);
+				auto const size = comparison.size;
+				if (!enum_id || (size != 1 && size != 2 && size != 4 && size != 8)) {
+					return this->fail("field type can't be compared");
+				}
+
+				comparison.kind = Comparison::Kind::Int;
+
+				if (kind == Token::Kind::Number) {
+					if (!internal::parse_number(literal, comparison.int_value)) {
+						return this->fail("expected an enum value");
+					}
+					return true;
+				}
+
+				auto const enum_def = this->kernel.enum_def_for(*enum_id);
+				auto const variant_name = internal::unqualified_name(literal, enum_def->name);
+				auto const variant = (kind == Token::Kind::Identifier && variant_name) ? enum_def->find_variant(*variant_name) : nullptr;
+				if (!variant) {
+					return this->fail(fmt::format("\"{}\" isn't a variant of {}", literal, enum_def->name));
+				}
+
+				comparison.int_value = variant->value;
+				return true;
+			}
+		};
+
+
+		template<class T>
+		void compare_column(T const* __restrict column, T value, CompareOp op, std::uint8_t* __restrict mask, std::size_t count) {
+			switch (op) {
+				case CompareOp::Equal: for (std::size_t idx = 0; idx < count; idx++) mask[idx] = column[idx] == value; break;
+				case CompareOp::NotEqual: for (std::size_t idx = 0; idx < count; idx++) mask[idx] = column[idx] != value; break;
+				case CompareOp::Less: for (std::size_t idx = 0; idx < count; idx++) mask[idx] = column[idx] < value; break;
+				case CompareOp::LessEqual: for (std::size_t idx = 0; idx < count; idx++) mask[idx] = column[idx] <= value; break;
+				case CompareOp::Greater: for (std::size_t idx = 0; idx < count; idx++) mask[idx] = column[idx] > value; break;
+				case CompareOp::GreaterEqual: for (std::size_t idx = 0; idx < count; idx++) mask[idx] = column[idx] >= value; break;
+			}
+		}
+
+
+		bool compare_ordering(int ordering, CompareOp op) {
+			switch (op) {
+				case CompareOp::Equal: return ordering == 0;
+				case CompareOp::NotEqual: return ordering != 0;
+				case CompareOp::Less: return ordering < 0;
+				case CompareOp::LessEqual: return ordering <= 0;
+				case CompareOp::Greater: return ordering > 0;
+				case CompareOp::GreaterEqual: return ordering >= 0;
+			}
+			return false;
+		}
+
+
+		// Evaluates the plan one batch at a time, calling on_batch(first_idx, mask, count) with a 0/1 byte per instance
+		template<class F>
+		void evaluate_batches(FilterPlan const& plan, StructSpan instances, F&& on_batch) {
+			auto const stride = instances.struct_def->size;
+
+			std::vector<std::uint8_t> masks(std::max<std::size_t>(plan.max_stack_depth, 1) * filter_batch_size);
+			std::vector<std::int64_t> int_column(filter_batch_size);
+			std::vector<float> float_column(filter_batch_size);
+
+			for (std::size_t first_idx = 0; first_idx < instances.count; first_idx += filter_batch_size) {
+				auto const count = std::min(filter_batch_size, instances.count - first_idx);
+				auto const batch_data = instances.data + first_idx * stride;
+
+				std::size_t depth = 0;
+				auto const mask_at = [&masks] (std::size_t level) { return masks.data() + level * filter_batch_size; };
+
+				for (auto const& op : plan.ops) {
+					switch (op.kind) {
+						case FilterPlan::OpKind::Compare: {
+							auto const& comparison = plan.comparisons[op.comparison_idx];
+							auto const mask = mask_at(depth++);
+
+							switch (comparison.kind) {
+								case Comparison::Kind::Int: {
+									for (std::size_t idx = 0; idx < count; idx++) {
+										int_column[idx] = internal::read_signed(batch_data + idx * stride + comparison.offset, comparison.size);
+									}
+									compare_column(int_column.data(), comparison.int_value, comparison.op, mask, count);
+									break;
+								}
+
+								case Comparison::Kind::Float: {
+									for (std::size_t idx = 0; idx < count; idx++) {
+										std::memcpy(&float_column[idx], batch_data + idx * stride + comparison.offset, sizeof(float));
+									}
+									compare_column(float_column.data(), static_cast<float>(comparison.float_value), comparison.op, mask, count);
+									break;
+								}
+
+								case Comparison::Kind::String: {
+									for (std::size_t idx = 0; idx < count; idx++) {
+										auto const& string = internal::read_string(batch_data + idx * stride + comparison.offset);
+										mask[idx] = compare_ordering(string.compare(comparison.string_value), comparison.op);
+									}
+									break;
+								}
+							}
+							break;
+						}
+
+						case FilterPlan::OpKind::And: {
+							depth--;
+							auto const lhs = mask_at(depth - 1);
+							auto const rhs = mask_at(depth);
+							for (std::size_t idx = 0; idx < count; idx++) lhs[idx] &= rhs[idx];
+							break;
+						}
+
+						case FilterPlan::OpKind::Or: {
+							depth--;
+							auto const lhs = mask_at(depth - 1);
+							auto const rhs = mask_at(depth);
+							for (std::size_t idx = 0; idx < count; idx++) lhs[idx] |= rhs[idx];
+							break;
+						}
+
+						case FilterPlan::OpKind::Not: {
+							auto const mask = mask_at(depth - 1);
+							for (std::size_t idx = 0; idx < count; idx++) mask[idx] ^= 1;
+							break;
+						}
+					}
+				}
+
+				on_batch(first_idx, static_cast<std::uint8_t const*>(mask_at(0)), count);
+			}
+		}
+	}
+
+
+	auto compile_filter(Kernel const& kernel, StructDef const* struct_def, std::string_view expression) -> FilterCompileResult {
+		FilterPlan plan {struct_def, {}, {}, 0};
+		FilterParser parser {kernel, expression, plan, lex(expression, 0), {}, 0, 0};
+
+		if (parser.parse_or() && parser.token.kind != Token::Kind::End) {
+			parser.fail("expected '&&', '||' or the end of the expression");
+		}
+
+		if (!parser.error.empty()) {
+			return FilterCompileResult{std::nullopt, std::move(parser.error), parser.error_offset};
+		}
+
+		return FilterCompileResult{std::move(plan), {}, 0};
+	}
+
+
+
+	auto FilterPlan::select_bitmap(StructSpan instances) const -> std::vector<std::uint64_t> {
+		std::vector<std::uint64_t> bitmap((instances.count + 63) / 64);
+
+		evaluate_batches(*this, instances, [&bitmap] (std::size_t first_idx, std::uint8_t const* mask, std::size_t count) {
+			for (std::size_t idx = 0; idx < count; idx++) {
+				auto const instance_idx = first_idx + idx;
+				bitmap[instance_idx / 64] |= std::uint64_t{mask[idx]} << (instance_idx % 64);
+			}
+		});
+
+		return bitmap;
+	}
+
+
+	auto FilterPlan::select_indices(StructSpan instances) const -> std::vector<std::uint32_t> {
+		std::vector<std::uint32_t> indices;
+
+		evaluate_batches(*this, instances, [&indices] (std::size_t first_idx, std::uint8_t const* mask, std::size_t count) {
+			for (std::size_t idx = 0; idx < count; idx++) {
+				if (mask[idx]) {
+					indices.push_back(static_cast<std::uint32_t>(first_idx + idx));
+				}
+			}
+		});
+
+		return indices;
+	}
+
+}
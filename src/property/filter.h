@@ -0,0 +1,85 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace property {
+
+	// A filter expression compiled against a registered struct, e.g.,
+	//
+	//     a_field > 5 && a_blah/meh < 2.0 && (womp == B || whatever != "skip")
+	//
+	// Each comparison is between a field path and a literal, combined with &&, || and !.
+	// Paths, enum variant names and literal types are resolved when compiling, so evaluation only reads
+	// fields at fixed offsets. Instances are evaluated in batches: each compared field is gathered into a
+	// column and compared with a tight loop, then the per comparison masks are combined.
+	struct FilterPlan {
+		enum class CompareOp {
+			Equal,
+			NotEqual,
+			Less,
+			LessEqual,
+			Greater,
+			GreaterEqual,
+		};
+
+		struct Comparison {
+			enum class Kind {
+				// Int and enum fields, sign extended to 64 bits
+				Int,
+				Float,
+				String,
+			};
+
+			std::uint32_t offset;
+			std::uint32_t size;
+			Kind kind;
+			CompareOp op;
+
+			std::int64_t int_value;
+			double float_value;
+			std::string string_value;
+		};
+
+		enum class OpKind {
+			Compare,
+			And,
+			Or,
+			Not,
+		};
+
+		// Expression in postfix order
+		struct Op {
+			OpKind kind;
+			std::uint32_t comparison_idx;
+		};
+
+		StructDef const* struct_def;
+		std::vector<Comparison> comparisons;
+		std::vector<Op> ops;
+		std::size_t max_stack_depth;
+
+		// Bit i of word i / 64 is set if instance i matches
+		auto select_bitmap(StructSpan instances) const -> std::vector<std::uint64_t>;
+		// Ascending indices of matching instances
+		auto select_indices(StructSpan instances) const -> std::vector<std::uint32_t>;
+	};
+
+
+	struct FilterCompileResult {
+		std::optional<FilterPlan> plan;
+		// Describes why compilation failed, and where in the expression
+		std::string error;
+		std::size_t error_offset;
+	};
+
+	// Numbers are parsed with std::from_chars, enums are compared by variant name (optionally qualified,
+	// e.g., "Wamp::B") or value, and strings are quoted, or unquoted if they're a single word.
+	auto compile_filter(Kernel const& kernel, StructDef const* struct_def, std::string_view expression) -> FilterCompileResult;
+
+} // property
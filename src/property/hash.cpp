@@ -0,0 +1,329 @@
+#include "property/hash.h"
+#include "property/internal/value_access.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace property {
+
+	namespace {
+		constexpr std::uint64_t hash_k0 = 0xa0761d6478bd642full;
+		constexpr std::uint64_t hash_k1 = 0xe7037ed1a0b428dbull;
+		constexpr std::uint64_t hash_k2 = 0x8ebc6af09c88c6e3ull;
+
+		__extension__ using u128 = unsigned __int128;
+
+		std::uint64_t hash_mix(std::uint64_t a, std::uint64_t b) {
+			auto const product = static_cast<u128>(a) * b;
+			return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+		}
+
+		std::uint64_t read_u64(std::byte const* ptr) {
+			std::uint64_t value;
+			std::memcpy(&value, ptr, sizeof value);
+			return value;
+		}
+
+		std::uint64_t read_u32(std::byte const* ptr) {
+			std::uint32_t value;
+			std::memcpy(&value, ptr, sizeof value);
+			return value;
+		}
+	}
+
+
+	// wyhash style hash, consuming 16 bytes per round
+	std::uint64_t internal::hash_bytes(std::byte const* data, std::size_t size, std::uint64_t seed) {
+		seed ^= hash_k0;
+
+		auto remaining = size;
+		while (remaining > 16) {
+			seed = hash_mix(read_u64(data) ^ hash_k1, read_u64(data + 8) ^ seed);
+			data += 16;
+			remaining -= 16;
+		}
+
+		std::uint64_t a = 0;
+		std::uint64_t b = 0;
+
+		if (remaining >= 8) {
+			a = read_u64(data);
+			b = read_u64(data + remaining - 8);
+		} else if (remaining >= 4) {
+			a = read_u32(data);
+			b = read_u32(data + remaining - 4);
+		} else if (remaining > 0) {
+			a = (std::uint64_t(data[0]) << 16) | (std::uint64_t(data[remaining / 2]) << 8) | std::uint64_t(data[remaining - 1]);
+		}
+
+		return hash_mix(hash_k2 ^ size, hash_mix(a ^ hash_k1, b ^ seed));
+	}
+
+
+
+	namespace {
+		struct HashPlanBuilder {
+			Kernel const& kernel;
+			std::vector<StructId> struct_stack;
+
+			auto build(StructDef const& struct_def) -> HashPlan {
+				HashPlan plan {&this->kernel, {}, {}};
+
+				this->struct_stack.push_back(struct_def.id);
+				this->add_struct_ops(plan, struct_def, 0);
+				this->struct_stack.pop_back();
+
+				std::stable_sort(plan.ops.begin(), plan.ops.end(), [] (auto&& lhs, auto&& rhs) {
+					return lhs.offset < rhs.offset;
+				});
+
+				// Merge adjacent byte ranges
+				std::vector<HashPlan::Op> merged_ops;
+				for (auto& op : plan.ops) {
+					if (!merged_ops.empty()) {
+						auto& prev = merged_ops.back();
+						if (prev.kind == HashPlan::OpKind::Bytes && op.kind == HashPlan::OpKind::Bytes
+							&& prev.offset + prev.size == op.offset)
+						{
+							prev.size += op.size;
+							continue;
+						}
+					}
+
+					merged_ops.push_back(op);
+				}
+
+				plan.ops = std::move(merged_ops);
+				return plan;
+			}
+
+			void add_struct_ops(HashPlan& plan, StructDef const& struct_def, std::uint32_t base_offset) {
+				for (auto const& field_def : struct_def.fields) {
+					auto const& field_info = field_def.field_info;
+					auto const offset = base_offset + static_cast<std::uint32_t>(field_info.offset);
+					auto const size = static_cast<std::uint32_t>(field_info.size);
+
+					if (auto struct_id = this->kernel.struct_id_from_type_id(field_info.type_id)) {
+						this->add_struct_ops(plan, *this->kernel.struct_def_for(*struct_id), offset);
+
+					} else if (field_def.list_info) {
+						this->add_list_op(plan, *field_def.list_info, offset, size);
+
+					} else if (field_info.type_id == TypeId::String) {
+						plan.ops.push_back({HashPlan::OpKind::String, offset, size, nullptr, std::nullopt, std::nullopt});
+
+					} else if (field_info.trivially_copyable) {
+						plan.ops.push_back({HashPlan::OpKind::Bytes, offset, size, nullptr, std::nullopt, std::nullopt});
+
+					} else {
+						plan.complete = false;
+					}
+				}
+			}
+
+			void add_list_op(HashPlan& plan, ListFieldInfo const& list_info, std::uint32_t offset, std::uint32_t size) {
+				HashPlan::Op op {HashPlan::OpKind::List, offset, size, &list_info, std::nullopt, std::nullopt};
+
+				if (auto struct_id = this->kernel.struct_id_from_type_id(list_info.element_type_id)) {
+					// The containing struct's own fields are already in the plan being built, so only the lookup is deferred
+					if (std::find(this->struct_stack.begin(), this->struct_stack.end(), *struct_id) != this->struct_stack.end()) {
+						op.recursive_element = *struct_id;
+					} else {
+						op.element_plan = static_cast<std::uint32_t>(plan.element_plans.size());
+						plan.element_plans.push_back(this->build(*this->kernel.struct_def_for(*struct_id)));
+						plan.complete = plan.complete && plan.element_plans.back().complete;
+					}
+
+				} else if (list_info.element_type_id != TypeId::String && !list_info.element_trivially_copyable) {
+					plan.complete = false;
+					return;
+				}
+
+				plan.ops.push_back(op);
+			}
+		};
+	}
+
+
+	auto make_hash_plan(Kernel const& kernel, StructDef const& struct_def) -> HashPlan {
+		return HashPlanBuilder{kernel, {}}.build(struct_def);
+	}
+
+
+
+	std::uint64_t HashPlan::hash(std::byte const* struct_ptr, std::uint64_t seed) const {
+		for (auto const& op : this->ops) {
+			auto const field_ptr = struct_ptr + op.offset;
+
+			switch (op.kind) {
+				case OpKind::Bytes:
+					seed = internal::hash_bytes(field_ptr, op.size, seed);
+					break;
+
+				case OpKind::String: {
+					auto const& string = internal::read_string(field_ptr);
+					seed = internal::hash_bytes(reinterpret_cast<std::byte const*>(string.data()), string.size(), seed);
+					break;
+				}
+
+				case OpKind::List: {
+					auto const& list_info = *op.list_info;
+					auto const list_size = list_info.get_size(field_ptr);
+					seed = hash_mix(seed ^ hash_k1, list_size ^ hash_k2);
+
+					if (list_size == 0) {
+						break;
+					}
+
+					if (auto const element_plan = this->element_plan_for(op)) {
+						for (std::size_t idx = 0; idx < list_size; idx++) {
+							seed = element_plan->hash(list_info.get_element_ptr(field_ptr, idx), seed);
+						}
+
+					} else if (list_info.element_type_id == TypeId::String) {
+						for (std::size_t idx = 0; idx < list_size; idx++) {
+							auto const& string = internal::read_string(list_info.get_element_ptr(field_ptr, idx));
+							seed = internal::hash_bytes(reinterpret_cast<std::byte const*>(string.data()), string.size(), seed);
+						}
+
+					} else if (list_info.contiguous) {
+						seed = internal::hash_bytes(list_info.get_element_ptr(field_ptr, 0), list_size * list_info.element_size, seed);
+
+					} else {
+						for (std::size_t idx = 0; idx < list_size; idx++) {
+							seed = internal::hash_bytes(list_info.get_element_ptr(field_ptr, idx), list_info.element_size, seed);
+						}
+					}
+					break;
+				}
+			}
+		}
+
+		return seed;
+	}
+
+
+	bool HashPlan::equal(std::byte const* lhs, std::byte const* rhs) const {
+		for (auto const& op : this->ops) {
+			auto const lhs_field = lhs + op.offset;
+			auto const rhs_field = rhs + op.offset;
+
+			switch (op.kind) {
+				case OpKind::Bytes:
+					if (std::memcmp(lhs_field, rhs_field, op.size) != 0) {
+						return false;
+					}
+					break;
+
+				case OpKind::String:
+					if (internal::read_string(lhs_field) != internal::read_string(rhs_field)) {
+						return false;
+					}
+					break;
+
+				case OpKind::List: {
+					auto const& list_info = *op.list_info;
+					auto const list_size = list_info.get_size(lhs_field);
+					if (list_size != list_info.get_size(rhs_field)) {
+						return false;
+					}
+
+					if (list_size == 0) {
+						break;
+					}
+
+					if (auto const element_plan = this->element_plan_for(op)) {
+						for (std::size_t idx = 0; idx < list_size; idx++) {
+							if (!element_plan->equal(list_info.get_element_ptr(lhs_field, idx), list_info.get_element_ptr(rhs_field, idx))) {
+								return false;
+							}
+						}
+
+					} else if (list_info.element_type_id == TypeId::String) {
+						for (std::size_t idx = 0; idx < list_size; idx++) {
+							if (internal::read_string(list_info.get_element_ptr(lhs_field, idx)) != internal::read_string(list_info.get_element_ptr(rhs_field, idx))) {
+								return false;
+							}
+						}
+
+					} else if (list_info.contiguous) {
+						auto const size = list_size * list_info.element_size;
+						if (std::memcmp(list_info.get_element_ptr(lhs_field, 0), list_info.get_element_ptr(rhs_field, 0), size) != 0) {
+							return false;
+						}
+
+					} else {
+						for (std::size_t idx = 0; idx < list_size; idx++) {
+							auto const lhs_element = list_info.get_element_ptr(lhs_field, idx);
+							auto const rhs_element = list_info.get_element_ptr(rhs_field, idx);
+							if (std::memcmp(lhs_element, rhs_element, list_info.element_size) != 0) {
+								return false;
+							}
+						}
+					}
+					break;
+				}
+			}
+		}
+
+		return true;
+	}
+
+
+	HashPlan const* HashPlan::element_plan_for(Op const& op) const {
+		if (op.element_plan) {
+			return &this->element_plans[*op.element_plan];
+		}
+
+		if (op.recursive_element) {
+			return this->kernel->hash_plan_for(*this->kernel->struct_def_for(*op.recursive_element)).get();
+		}
+
+		return nullptr;
+	}
+
+
+
+	auto Kernel::hash_plan_for(StructDef const& struct_def) const -> std::shared_ptr<HashPlan const> {
+		{
+			std::shared_lock lock {this->cached_plans_mutex};
+			auto const plan_it = this->hash_plans.find(struct_def.id);
+			if (plan_it != this->hash_plans.end()) {
+				return plan_it->second;
+			}
+		}
+
+		// Built outside the lock. If two threads race, both plans are identical and the first one stored wins
+		auto plan = std::make_shared<HashPlan const>(make_hash_plan(*this, struct_def));
+
+		std::lock_guard lock {this->cached_plans_mutex};
+		return this->hash_plans.try_emplace(struct_def.id, std::move(plan)).first->second;
+	}
+
+
+
+	std::optional<std::uint64_t> hash(Kernel const& kernel, StructRef struct_ref) {
+		auto const plan = kernel.hash_plan_for(*struct_ref.struct_def);
+		if (!plan->complete) {
+			return std::nullopt;
+		}
+
+		return plan->hash(struct_ref.struct_ptr);
+	}
+
+
+	std::optional<bool> equal(Kernel const& kernel, StructRef lhs, StructRef rhs) {
+		if (lhs.struct_def != rhs.struct_def) {
+			return false;
+		}
+
+		auto const plan = kernel.hash_plan_for(*lhs.struct_def);
+		if (!plan->complete) {
+			return std::nullopt;
+		}
+
+		return plan->equal(lhs.struct_ptr, rhs.struct_ptr);
+	}
+
+}
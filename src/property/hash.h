@@ -0,0 +1,66 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace property {
+
+	namespace internal {
+		std::uint64_t hash_bytes(std::byte const* data, std::size_t size, std::uint64_t seed);
+	}
+
+
+	// Precomputed layout walk for hashing and comparing instances of a registered struct.
+	// Nested structs are flattened, padding is skipped and adjacent trivially copyable fields are
+	// coalesced into single runs, so a struct without padding hashes as one contiguous block.
+	// Trivially copyable fields are compared bytewise, so e.g., 0.0f and -0.0f are considered distinct.
+	// Fields that are neither trivially copyable, strings, lists nor registered structs can't be compared,
+	// and neither can lists of them. They're skipped, and the plan is marked incomplete.
+	struct HashPlan {
+		enum class OpKind {
+			Bytes,
+			String,
+			List,
+		};
+
+		struct Op {
+			OpKind kind;
+			std::uint32_t offset;
+			std::uint32_t size;
+
+			ListFieldInfo const* list_info = nullptr;
+			// Index into element_plans for lists of registered structs
+			std::optional<std::uint32_t> element_plan;
+			// Lists of a struct that contains the list, e.g., std::vector<Node> in Node, which can't be
+			// flattened into the plan. The element plan is looked up with Kernel::hash_plan_for when used
+			std::optional<StructId> recursive_element;
+		};
+
+		Kernel const* kernel;
+		std::vector<Op> ops;
+		std::vector<HashPlan> element_plans;
+		// False if any field was skipped, including fields of list elements
+		bool complete = true;
+
+		// Only covers the fields in the plan, so check complete first
+		std::uint64_t hash(std::byte const* struct_ptr, std::uint64_t seed = 0) const;
+		bool equal(std::byte const* lhs, std::byte const* rhs) const;
+
+		// The plan for the elements of a list of registered structs, or nullptr for other lists.
+		// Plans of recursive lists are owned by the Kernel's cache, so are only valid until the next registration
+		HashPlan const* element_plan_for(Op const& op) const;
+	};
+
+
+	auto make_hash_plan(Kernel const& kernel, StructDef const& struct_def) -> HashPlan;
+
+	// Convenience wrappers using the plan cached by Kernel::hash_plan_for. Each call still takes a shared lock
+	// to find it, so when hashing many instances in a tight loop, hold a plan instead.
+	// Return nullopt if the plan is incomplete, rather than ignoring the fields it can't compare
+	std::optional<std::uint64_t> hash(Kernel const& kernel, StructRef struct_ref);
+	std::optional<bool> equal(Kernel const& kernel, StructRef lhs, StructRef rhs);
+
+} // property
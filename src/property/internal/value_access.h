@@ -0,0 +1,73 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace property {
+
+	// Helpers for reading and writing type erased field values, shared by the modules that walk StructDefs
+	namespace internal {
+		inline std::string const& read_string(std::byte const* ptr) {
+			return *std::launder(reinterpret_cast<std::string const*>(ptr));
+		}
+
+		inline std::string& read_string_mut(std::byte* ptr) {
+			return *std::launder(reinterpret_cast<std::string*>(ptr));
+		}
+
+
+		// Reads a signed integer or enum of size 1, 2, 4 or 8. Other sizes are read as 8 bytes
+		inline std::int64_t read_signed(std::byte const* ptr, std::size_t size) {
+			switch (size) {
+				case 1: { std::int8_t v; std::memcpy(&v, ptr, 1); return v; }
+				case 2: { std::int16_t v; std::memcpy(&v, ptr, 2); return v; }
+				case 4: { std::int32_t v; std::memcpy(&v, ptr, 4); return v; }
+				default: { std::int64_t v; std::memcpy(&v, ptr, 8); return v; }
+			}
+		}
+
+		// Truncates value to size bytes. Returns false, writing nothing, if size isn't 1, 2, 4 or 8
+		inline bool write_signed(std::int64_t value, std::size_t size, std::byte* ptr) {
+			switch (size) {
+				case 1: { auto const v = static_cast<std::int8_t>(value); std::memcpy(ptr, &v, 1); return true; }
+				case 2: { auto const v = static_cast<std::int16_t>(value); std::memcpy(ptr, &v, 2); return true; }
+				case 4: { auto const v = static_cast<std::int32_t>(value); std::memcpy(ptr, &v, 4); return true; }
+				case 8: { std::memcpy(ptr, &value, 8); return true; }
+				default: return false;
+			}
+		}
+
+
+		// Parses the whole of text as a number, allowing a leading '+'
+		template<class T>
+		bool parse_number(std::string_view text, T& value) {
+			if (!text.empty() && text.front() == '+') {
+				text.remove_prefix(1);
+			}
+
+			auto const end = text.data() + text.size();
+			auto const [ptr, error] = std::from_chars(text.data(), end, value);
+			return error == std::errc{} && ptr == end;
+		}
+
+
+		// Strips the enum's name from a qualified variant name, e.g., "Wamp::B" becomes "B".
+		// Returns nullopt if the name is qualified with anything other than enum_name
+		inline std::optional<std::string_view> unqualified_name(std::string_view name, std::string_view enum_name) {
+			if (auto const qualifier_end = name.rfind("::"); qualifier_end != std::string_view::npos) {
+				if (name.substr(0, qualifier_end) != enum_name) {
+					return std::nullopt;
+				}
+				name.remove_prefix(qualifier_end + 2);
+			}
+			return name;
+		}
+	}
+
+} // property
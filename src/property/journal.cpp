@@ -0,0 +1,218 @@
+#include "property/journal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+namespace property {
+
+	static bool is_journalable(FieldDef const& field_def) {
+		return field_def.field_info.trivially_copyable
+			|| field_def.field_info.type_id == TypeId::String;
+	}
+
+
+	static std::span<std::byte const> field_contents(FieldRef field) {
+		if (field.field_def->field_info.trivially_copyable) {
+			return {field.field_ptr, field.field_def->field_info.size};
+		}
+
+		auto const& string = *field.try_read<std::string>();
+		return std::as_bytes(std::span{string.data(), string.size()});
+	}
+
+
+	static void assign_field_contents(FieldMutRef field, std::span<std::byte const> contents) {
+		if (field.field_def->field_info.trivially_copyable) {
+			std::memcpy(field.field_ptr, contents.data(), contents.size());
+			return;
+		}
+
+		auto& string = *field.try_get<std::string>();
+		string.assign(reinterpret_cast<char const*>(contents.data()), contents.size());
+	}
+
+
+	static void append_bytes(std::vector<std::byte>& arena, void const* data, std::size_t size) {
+		auto const bytes = static_cast<std::byte const*>(data);
+		arena.insert(arena.end(), bytes, bytes + size);
+	}
+
+
+
+	void Journal::begin_transaction() {
+		if (this->in_transaction) {
+			return;
+		}
+
+		this->in_transaction = true;
+		this->transaction_records = 0;
+	}
+
+
+	void Journal::commit_transaction() {
+		if (!this->in_transaction) {
+			return;
+		}
+
+		this->in_transaction = false;
+
+		if (this->transaction_records == 0) {
+			return;
+		}
+
+		this->transactions.push_back(Transaction {
+			this->transaction_begin,
+			this->arena.size(),
+			this->transaction_records,
+		});
+
+		this->applied_transactions = this->transactions.size();
+	}
+
+
+	bool Journal::undo(InstanceResolver const& resolver) {
+		if (this->in_transaction || !this->can_undo()) {
+			return false;
+		}
+
+		this->applied_transactions--;
+		this->apply_transaction(this->transactions[this->applied_transactions], resolver, false);
+		return true;
+	}
+
+
+	bool Journal::redo(InstanceResolver const& resolver) {
+		if (this->in_transaction || !this->can_redo()) {
+			return false;
+		}
+
+		this->apply_transaction(this->transactions[this->applied_transactions], resolver, true);
+		this->applied_transactions++;
+		return true;
+	}
+
+
+	void Journal::clear() {
+		this->arena.clear();
+		this->transactions.clear();
+		this->applied_transactions = 0;
+		this->in_transaction = false;
+		this->transaction_records = 0;
+	}
+
+
+
+	bool Journal::begin_record(InstanceId instance_id, StructId struct_id, std::span<FieldIdx const> field_path, FieldRef field) {
+		if (!is_journalable(*field.field_def)) {
+			return false;
+		}
+
+		if (this->transaction_records > 0) {
+			RecordHeader last;
+			std::memcpy(&last, this->arena.data() + this->last_record_begin, sizeof last);
+
+			auto const last_path_ptr = this->arena.data() + this->last_record_begin + sizeof last;
+			auto const path_bytes = field_path.size_bytes();
+
+			bool const same_field = last.instance_id == instance_id
+				&& last.struct_id == struct_id
+				&& last.path_length == field_path.size()
+				&& std::memcmp(last_path_ptr, field_path.data(), path_bytes) == 0;
+
+			// Keep the original old contents, and overwrite the new contents in end_record
+			if (same_field) {
+				this->arena.resize(this->last_record_begin + sizeof last + path_bytes + last.old_size);
+				return true;
+			}
+
+		} else {
+			// Starting a new transaction discards anything that was undone
+			auto const history_end = this->applied_transactions > 0
+				? this->transactions[this->applied_transactions-1].arena_end
+				: 0;
+
+			this->arena.resize(history_end);
+			this->transactions.resize(this->applied_transactions);
+			this->transaction_begin = history_end;
+		}
+
+		auto const old_contents = field_contents(field);
+
+		RecordHeader const header {
+			instance_id,
+			struct_id,
+			static_cast<std::uint32_t>(field_path.size()),
+			static_cast<std::uint32_t>(old_contents.size()),
+			0,
+		};
+
+		this->last_record_begin = this->arena.size();
+		this->transaction_records++;
+
+		append_bytes(this->arena, &header, sizeof header);
+		append_bytes(this->arena, field_path.data(), field_path.size_bytes());
+		append_bytes(this->arena, old_contents.data(), old_contents.size());
+		return true;
+	}
+
+
+	void Journal::end_record(FieldRef field) {
+		auto const new_contents = field_contents(field);
+		append_bytes(this->arena, new_contents.data(), new_contents.size());
+
+		auto const new_size = static_cast<std::uint32_t>(new_contents.size());
+		auto const header_ptr = this->arena.data() + this->last_record_begin;
+		std::memcpy(header_ptr + offsetof(RecordHeader, new_size), &new_size, sizeof new_size);
+	}
+
+
+	void Journal::apply_transaction(Transaction const& transaction, InstanceResolver const& resolver, bool forwards) const {
+		std::vector<std::size_t> record_offsets;
+		record_offsets.reserve(transaction.record_count);
+
+		for (auto offset = transaction.arena_begin; offset < transaction.arena_end;) {
+			RecordHeader header;
+			std::memcpy(&header, this->arena.data() + offset, sizeof header);
+
+			record_offsets.push_back(offset);
+			offset += sizeof header + header.path_length * sizeof(FieldIdx) + header.old_size + header.new_size;
+		}
+
+		if (!forwards) {
+			std::reverse(record_offsets.begin(), record_offsets.end());
+		}
+
+		std::vector<FieldIdx> field_path;
+
+		for (auto offset : record_offsets) {
+			RecordHeader header;
+			std::memcpy(&header, this->arena.data() + offset, sizeof header);
+
+			auto const path_ptr = this->arena.data() + offset + sizeof header;
+			auto const old_ptr = path_ptr + header.path_length * sizeof(FieldIdx);
+			auto const new_ptr = old_ptr + header.old_size;
+
+			field_path.resize(header.path_length);
+			std::memcpy(field_path.data(), path_ptr, header.path_length * sizeof(FieldIdx));
+
+			auto const struct_def = this->kernel->struct_def_for(header.struct_id);
+			auto const struct_ptr = resolver(header.instance_id, header.struct_id);
+			if (!struct_def || !struct_ptr) {
+				continue;
+			}
+
+			auto const field = resolve_field_idx_path(*this->kernel, StructMutRef{struct_def, struct_ptr}, field_path);
+			if (!field) {
+				continue;
+			}
+
+			if (forwards) {
+				assign_field_contents(*field, {new_ptr, header.new_size});
+			} else {
+				assign_field_contents(*field, {old_ptr, header.old_size});
+			}
+		}
+	}
+
+}
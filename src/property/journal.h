@@ -0,0 +1,86 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace property {
+
+	using InstanceId = std::uint64_t;
+
+	// Maps an instance id back to the struct it names, for replaying journal entries.
+	// Returning nullptr skips entries for that instance.
+	using InstanceResolver = std::function<std::byte*(InstanceId, StructId)>;
+
+
+	// Append-only record of field writes, grouped into transactions that can be undone and redone.
+	// Each write stores only the path to the field and its old and new contents, so history grows with
+	// the amount of data changed rather than the size of the objects being edited.
+	// Only trivially copyable and std::string fields can be journaled.
+	struct Journal {
+		Kernel const* kernel;
+
+		Journal(Kernel const& kernel) : kernel{&kernel} {}
+
+		void begin_transaction();
+		// Empty transactions are dropped. Committing discards any transactions that were undone
+		void commit_transaction();
+
+		// Writes value to the field at field_path, recording the change in the current transaction.
+		// If no transaction is open, the write is committed as its own transaction.
+		// Consecutive writes to the same field within a transaction are merged.
+		template<class F>
+		bool write(InstanceId instance_id, StructMutRef struct_ref, std::string_view field_path, F value);
+
+		template<class F>
+		bool write(InstanceId instance_id, StructMutRef struct_ref, std::span<FieldIdx const> field_path, F value);
+
+		bool undo(InstanceResolver const& resolver);
+		bool redo(InstanceResolver const& resolver);
+
+		bool can_undo() const { return applied_transactions > 0; }
+		bool can_redo() const { return applied_transactions < transactions.size(); }
+
+		auto transaction_count() const { return transactions.size(); }
+		auto arena_size() const { return arena.size(); }
+
+		void clear();
+
+	private:
+		struct RecordHeader {
+			InstanceId instance_id;
+			StructId struct_id;
+			std::uint32_t path_length;
+			std::uint32_t old_size;
+			std::uint32_t new_size;
+		};
+
+		struct Transaction {
+			std::size_t arena_begin;
+			std::size_t arena_end;
+			std::size_t record_count;
+		};
+
+		// Records the old contents of field. Must be followed by end_record once the field has been written
+		bool begin_record(InstanceId, StructId, std::span<FieldIdx const> field_path, FieldRef field);
+		void end_record(FieldRef field);
+
+		void apply_transaction(Transaction const&, InstanceResolver const&, bool forwards) const;
+
+		std::vector<std::byte> arena;
+		std::vector<Transaction> transactions;
+		std::size_t applied_transactions = 0;
+
+		bool in_transaction = false;
+		std::size_t transaction_begin = 0;
+		std::size_t transaction_records = 0;
+		std::size_t last_record_begin = 0;
+	};
+
+} // property
+
+
+#include "property/journal.inl"
@@ -0,0 +1,39 @@
+namespace property {
+
+	template<class F>
+	bool Journal::write(InstanceId instance_id, StructMutRef struct_ref, std::string_view field_path, F value) {
+		auto const field_idxs = field_idx_path(*this->kernel, struct_ref.struct_def, field_path);
+		if (!field_idxs) {
+			return false;
+		}
+
+		return this->write(instance_id, struct_ref, std::span<FieldIdx const>{*field_idxs}, std::move(value));
+	}
+
+
+	template<class F>
+	bool Journal::write(InstanceId instance_id, StructMutRef struct_ref, std::span<FieldIdx const> field_path, F value) {
+		auto const field_ref = resolve_field_idx_path(*this->kernel, struct_ref, field_path);
+		if (!field_ref || !field_ref->field_def->field_info.template matches_type<F>()) {
+			return false;
+		}
+
+		bool const owns_transaction = !this->in_transaction;
+		if (owns_transaction) {
+			this->begin_transaction();
+		}
+
+		bool const recorded = this->begin_record(instance_id, struct_ref.struct_def->id, field_path, *field_ref);
+		if (recorded) {
+			field_ref->try_write(std::move(value));
+			this->end_record(*field_ref);
+		}
+
+		if (owns_transaction) {
+			this->commit_transaction();
+		}
+
+		return recorded;
+	}
+
+} // property
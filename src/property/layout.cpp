@@ -0,0 +1,265 @@
+#include "property/layout.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include <fmt/format.h>
+
+namespace property {
+
+	namespace {
+		std::size_t align_up(std::size_t offset, std::size_t alignment) {
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+
+		auto find_gaps(StructDef const& struct_def) -> std::vector<StructLayoutReport::Gap> {
+			std::vector<FieldTypeInfo const*> fields_by_offset;
+			for (auto const& field_def : struct_def.fields) {
+				fields_by_offset.push_back(&field_def.field_info);
+			}
+
+			std::sort(fields_by_offset.begin(), fields_by_offset.end(), [] (auto&& lhs, auto&& rhs) {
+				return lhs->offset < rhs->offset;
+			});
+
+			std::vector<StructLayoutReport::Gap> gaps;
+			std::size_t cursor = 0;
+
+			auto const add_gap = [&gaps, &cursor] (std::size_t end, std::size_t next_alignment) {
+				auto const kind = end == align_up(cursor, next_alignment)
+					? StructLayoutReport::Gap::Kind::Padding
+					: StructLayoutReport::Gap::Kind::Unregistered;
+				gaps.push_back({cursor, end - cursor, kind});
+			};
+
+			for (auto const field_info : fields_by_offset) {
+				if (field_info->offset > cursor) {
+					add_gap(field_info->offset, field_info->alignment);
+				}
+				cursor = std::max(cursor, field_info->offset + field_info->size);
+			}
+
+			if (struct_def.size > cursor) {
+				add_gap(struct_def.size, struct_def.alignment);
+			}
+
+			return gaps;
+		}
+
+
+		void add_padding_by_depth(Kernel const& kernel, StructDef const& struct_def, std::size_t depth, std::vector<std::size_t>& padding_by_depth) {
+			if (padding_by_depth.size() <= depth) {
+				padding_by_depth.resize(depth + 1);
+			}
+
+			for (auto const& gap : find_gaps(struct_def)) {
+				if (gap.kind == StructLayoutReport::Gap::Kind::Padding) {
+					padding_by_depth[depth] += gap.size;
+				}
+			}
+
+			for (auto const& field_def : struct_def.fields) {
+				if (auto struct_id = kernel.struct_id_from_type_id(field_def.field_info.type_id)) {
+					add_padding_by_depth(kernel, *kernel.struct_def_for(*struct_id), depth + 1, padding_by_depth);
+				}
+			}
+		}
+
+
+		// Fields marked hot by attribute, then the most accessed fields while they still fit in a cache line
+		auto find_hot_fields(StructDef const& struct_def, std::span<std::uint64_t const> access_counts, internal::HotFieldFn hot_fn)
+			-> std::vector<FieldIdx>
+		{
+			std::vector<FieldIdx> hot_fields;
+			std::size_t hot_bytes = 0;
+
+			auto const is_hot = [&hot_fields] (FieldIdx field_idx) {
+				return std::find(hot_fields.begin(), hot_fields.end(), field_idx) != hot_fields.end();
+			};
+
+			for (FieldIdx field_idx = 0; field_idx < struct_def.fields.size(); field_idx++) {
+				if (hot_fn && hot_fn(struct_def.fields[field_idx])) {
+					hot_fields.push_back(field_idx);
+					hot_bytes += struct_def.fields[field_idx].field_info.size;
+				}
+			}
+
+			std::vector<FieldIdx> counted_fields;
+			for (FieldIdx field_idx = 0; field_idx < std::min(access_counts.size(), struct_def.fields.size()); field_idx++) {
+				if (access_counts[field_idx] > 0 && !is_hot(field_idx)) {
+					counted_fields.push_back(field_idx);
+				}
+			}
+
+			std::stable_sort(counted_fields.begin(), counted_fields.end(), [&access_counts] (FieldIdx lhs, FieldIdx rhs) {
+				return access_counts[lhs] > access_counts[rhs];
+			});
+
+			for (auto const field_idx : counted_fields) {
+				auto const size = struct_def.fields[field_idx].field_info.size;
+				if (hot_bytes + size > StructLayoutReport::cache_line_size) {
+					break;
+				}
+
+				hot_fields.push_back(field_idx);
+				hot_bytes += size;
+			}
+
+			std::sort(hot_fields.begin(), hot_fields.end());
+			return hot_fields;
+		}
+
+
+		auto analyze_struct(Kernel const& kernel, StructDef const& struct_def, std::span<std::uint64_t const> access_counts,
+			internal::HotFieldFn hot_fn) -> StructLayoutReport
+		{
+			StructLayoutReport report {
+				struct_def.id,
+				struct_def.name,
+				struct_def.size,
+				struct_def.alignment,
+				find_gaps(struct_def),
+				0,
+				{},
+				{},
+				0,
+				find_hot_fields(struct_def, access_counts, hot_fn),
+				true,
+				true,
+			};
+
+			add_padding_by_depth(kernel, struct_def, 0, report.padding_by_depth);
+
+			for (auto const& gap : report.gaps) {
+				if (gap.kind == StructLayoutReport::Gap::Kind::Unregistered) {
+					report.unregistered_bytes += gap.size;
+				}
+			}
+
+			auto const is_hot = [&report] (FieldIdx field_idx) {
+				return std::binary_search(report.hot_fields.begin(), report.hot_fields.end(), field_idx);
+			};
+
+			// Ordering by decreasing alignment leaves no padding between fields whose sizes are multiples of
+			// their alignment, which is all of them for standard layout types
+			report.suggested_order.resize(struct_def.fields.size());
+			std::iota(report.suggested_order.begin(), report.suggested_order.end(), FieldIdx{0});
+
+			std::stable_sort(report.suggested_order.begin(), report.suggested_order.end(), [&] (FieldIdx lhs, FieldIdx rhs) {
+				auto const& lhs_info = struct_def.fields[lhs].field_info;
+				auto const& rhs_info = struct_def.fields[rhs].field_info;
+
+				if (is_hot(lhs) != is_hot(rhs)) {
+					return is_hot(lhs);
+				}
+				if (lhs_info.alignment != rhs_info.alignment) {
+					return lhs_info.alignment > rhs_info.alignment;
+				}
+				return lhs_info.size > rhs_info.size;
+			});
+
+			std::size_t offset = 0;
+			for (auto const field_idx : report.suggested_order) {
+				auto const& field_info = struct_def.fields[field_idx].field_info;
+				offset = align_up(offset, field_info.alignment) + field_info.size;
+
+				if (is_hot(field_idx) && offset > StructLayoutReport::cache_line_size) {
+					report.suggested_hot_fields_in_first_cache_line = false;
+				}
+			}
+			report.suggested_size = report.unregistered_bytes > 0 ? struct_def.size : align_up(offset, struct_def.alignment);
+
+			for (auto const field_idx : report.hot_fields) {
+				auto const& field_info = struct_def.fields[field_idx].field_info;
+				if (field_info.offset + field_info.size > StructLayoutReport::cache_line_size) {
+					report.hot_fields_in_first_cache_line = false;
+				}
+			}
+
+			return report;
+		}
+
+
+		void collect_nested_structs(Kernel const& kernel, StructDef const& struct_def, std::vector<StructDef const*>& struct_defs) {
+			for (auto const& field_def : struct_def.fields) {
+				auto struct_id = kernel.struct_id_from_type_id(field_def.field_info.type_id);
+				if (!struct_id) {
+					continue;
+				}
+
+				auto const nested_def = kernel.struct_def_for(*struct_id);
+				if (std::find(struct_defs.begin(), struct_defs.end(), nested_def) == struct_defs.end()) {
+					struct_defs.push_back(nested_def);
+					collect_nested_structs(kernel, *nested_def, struct_defs);
+				}
+			}
+		}
+	}
+
+
+	std::size_t StructLayoutReport::padding_bytes() const {
+		return std::accumulate(this->padding_by_depth.begin(), this->padding_by_depth.end(), std::size_t{0});
+	}
+
+
+	auto internal::analyze_layout(Kernel const& kernel, StructDef const& struct_def, LayoutOptions options, HotFieldFn hot_fn) -> LayoutReport {
+		std::vector<StructDef const*> struct_defs {&struct_def};
+		collect_nested_structs(kernel, struct_def, struct_defs);
+
+		LayoutReport report {{}, options.instance_count, 0, 0};
+
+		for (auto const nested_def : struct_defs) {
+			// Access counts are indexed by the analysed struct's fields
+			auto const access_counts = nested_def == &struct_def ? options.access_counts : std::span<std::uint64_t const>{};
+			report.structs.push_back(analyze_struct(kernel, *nested_def, access_counts, hot_fn));
+		}
+
+		auto const& root = report.structs.front();
+		report.weighted_padding_bytes = root.padding_bytes() * options.instance_count;
+		report.weighted_savings = root.savings() * options.instance_count;
+
+		return report;
+	}
+
+
+	auto analyze_layout(Kernel const& kernel, StructDef const& struct_def, LayoutOptions options) -> LayoutReport {
+		return internal::analyze_layout(kernel, struct_def, options, nullptr);
+	}
+
+
+
+	std::string format_debug(LayoutReport const& report) {
+		std::string out;
+		fmt::format_to(std::back_inserter(out), "{} instances: {} padding bytes, {} bytes saved by reordering\n",
+			report.instance_count, report.weighted_padding_bytes, report.weighted_savings);
+
+		for (auto const& struct_report : report.structs) {
+			fmt::format_to(std::back_inserter(out), "struct \"{}\" (size: {}, alignment: {}): {} padding bytes, by depth [{}]\n",
+				struct_report.name, struct_report.size, struct_report.alignment, struct_report.padding_bytes(),
+				fmt::join(struct_report.padding_by_depth, ", "));
+
+			if (struct_report.unregistered_bytes > 0) {
+				fmt::format_to(std::back_inserter(out), "    {} bytes of unregistered members\n", struct_report.unregistered_bytes);
+			}
+
+			for (auto const& gap : struct_report.gaps) {
+				bool const is_padding = gap.kind == StructLayoutReport::Gap::Kind::Padding;
+				fmt::format_to(std::back_inserter(out), "    gap at {}: {} bytes ({})\n", gap.offset, gap.size,
+					is_padding ? "padding" : "unregistered");
+			}
+
+			fmt::format_to(std::back_inserter(out), "    suggested order: [{}] (size: {})\n",
+				fmt::join(struct_report.suggested_order, ", "), struct_report.suggested_size);
+
+			if (!struct_report.hot_fields.empty()) {
+				fmt::format_to(std::back_inserter(out), "    hot fields: [{}], in first cache line: {} (suggested: {})\n",
+					fmt::join(struct_report.hot_fields, ", "), struct_report.hot_fields_in_first_cache_line,
+					struct_report.suggested_hot_fields_in_first_cache_line);
+			}
+		}
+
+		return out;
+	}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace property {
+
+	struct LayoutOptions {
+		// Number of live instances, used to weight the totals
+		std::size_t instance_count = 1;
+
+		// Optional instrumentation counts indexed by FieldIdx. The most accessed fields are considered hot,
+		// as many as fit in a cache line alongside those marked hot by attribute
+		std::span<std::uint64_t const> access_counts = {};
+	};
+
+
+	// Padding and field order analysis of a registered struct.
+	// Only registered fields are visible, so bytes they don't cover are either padding, if the gap is exactly
+	// what aligning the next registered field (or the struct's size) requires, or unregistered members otherwise.
+	// Unregistered gaps aren't counted as padding.
+	struct StructLayoutReport {
+		static constexpr std::size_t cache_line_size = 64;
+
+		struct Gap {
+			enum class Kind {
+				Padding,
+				// Holds one or more unregistered members, possibly with padding around them
+				Unregistered,
+			};
+
+			std::size_t offset;
+			std::size_t size;
+			Kind kind;
+		};
+
+		StructId struct_id;
+		std::string_view name;
+		std::size_t size;
+		std::size_t alignment;
+
+		// Bytes not covered by the struct's own fields
+		std::vector<Gap> gaps;
+		std::size_t unregistered_bytes;
+		// Padding bytes by nesting depth. Index 0 is the struct's own padding, index 1 the padding inside
+		// its nested struct fields, and so on
+		std::vector<std::size_t> padding_by_depth;
+
+		// Field order, hot fields first, and each group ordered by decreasing alignment.
+		// Nested structs are kept as is; they have their own reports in LayoutReport::structs.
+		// The suggestion can't place unregistered members, so if there are any, suggested_size is just size
+		std::vector<FieldIdx> suggested_order;
+		std::size_t suggested_size;
+
+		std::vector<FieldIdx> hot_fields;
+		// Whether all hot fields lie within the first cache line of the current and suggested layouts
+		bool hot_fields_in_first_cache_line;
+		bool suggested_hot_fields_in_first_cache_line;
+
+		std::size_t padding_bytes() const;
+		// Bytes saved per instance by the suggested order
+		std::size_t savings() const { return size > suggested_size ? size - suggested_size : 0; }
+	};
+
+
+	struct LayoutReport {
+		// The analysed struct first, then each nested struct it contains, once
+		std::vector<StructLayoutReport> structs;
+
+		std::size_t instance_count;
+		// Padding across all instances, including padding within nested structs
+		std::size_t weighted_padding_bytes;
+		// Bytes saved across all instances by reordering the analysed struct's fields
+		std::size_t weighted_savings;
+	};
+
+
+	namespace internal {
+		using HotFieldFn = bool (*)(FieldDef const&);
+
+		auto analyze_layout(Kernel const&, StructDef const&, LayoutOptions, HotFieldFn) -> LayoutReport;
+	}
+
+	auto analyze_layout(Kernel const& kernel, StructDef const& struct_def, LayoutOptions options = {}) -> LayoutReport;
+
+	// Also treats fields with a HotAttribute as hot, e.g., analyze_layout<HotAttribute>(...)
+	template<class HotAttribute>
+	auto analyze_layout(Kernel const& kernel, StructDef const& struct_def, LayoutOptions options = {}) -> LayoutReport;
+
+
+	std::string format_debug(LayoutReport const& report);
+
+} // property
+
+
+#include "property/layout.inl"
@@ -0,0 +1,12 @@
+namespace property {
+
+	template<class HotAttribute>
+	auto analyze_layout(Kernel const& kernel, StructDef const& struct_def, LayoutOptions options) -> LayoutReport {
+		auto const hot_fn = [] (FieldDef const& field_def) {
+			return field_def.attributes.get_attribute<HotAttribute>() != nullptr;
+		};
+
+		return internal::analyze_layout(kernel, struct_def, options, hot_fn);
+	}
+
+} // property
@@ -0,0 +1,353 @@
+#include "property/loader.h"
+#include "property/hash.h"
+#include "property/schema.h"
+#include "property/serialize.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace property {
+
+	namespace {
+		using Clock = std::chrono::steady_clock;
+
+		double seconds_since(Clock::time_point start) {
+			return std::chrono::duration<double>(Clock::now() - start).count();
+		}
+
+
+		// What a deserialize thread needs to know about each registered struct, computed once per load
+		struct LoadableStruct {
+			StructDef const* struct_def;
+			SchemaFingerprint fingerprint;
+			HashPlan plan;
+		};
+
+
+		struct ReadFile {
+			std::size_t file_idx;
+			std::vector<std::byte> data;
+		};
+
+
+		bool read_file(std::string const& path, std::vector<std::byte>& data, std::size_t& size,
+			std::function<void(std::size_t)> const& reserve_budget)
+		{
+			auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0) {
+				return false;
+			}
+
+			struct stat file_stat;
+			if (::fstat(fd, &file_stat) != 0) {
+				::close(fd);
+				return false;
+			}
+
+			size = static_cast<std::size_t>(file_stat.st_size);
+			reserve_budget(size);
+			data.resize(size);
+
+			std::size_t offset = 0;
+			while (offset < size) {
+				auto const result = ::pread(fd, data.data() + offset, size - offset, static_cast<off_t>(offset));
+				if (result < 0 && errno == EINTR) {
+					continue;
+				}
+				if (result <= 0) {
+					break;
+				}
+				offset += static_cast<std::size_t>(result);
+			}
+
+			::close(fd);
+			return offset == size;
+		}
+
+
+		struct LoadPipeline {
+			Kernel const& kernel;
+			StructPools& pools;
+			std::span<std::string const> paths;
+			LoaderOptions options;
+
+			LoadPipeline(Kernel const& kernel, StructPools& pools, std::span<std::string const> paths, LoaderOptions options)
+				: kernel{kernel}, pools{pools}, paths{paths}, options{options} {}
+
+			std::unordered_map<std::string_view, LoadableStruct> structs_by_name;
+			std::vector<LoadedFile> files;
+
+			std::atomic<std::size_t> next_file_idx = 0;
+
+			// Files read but not yet deserialized
+			std::mutex queue_mutex;
+			std::condition_variable queue_cv;
+			std::deque<ReadFile> queue;
+			std::size_t running_io_threads = 0;
+
+			std::mutex budget_mutex;
+			std::condition_variable budget_cv;
+			std::size_t buffered_bytes = 0;
+
+			// Guards the StructPools, for creating and destroying instances. Instances are filled without it
+			std::mutex pools_mutex;
+
+			std::mutex stats_mutex;
+			LoaderStats stats;
+
+
+			void reserve_budget(std::size_t bytes, double& stall_seconds) {
+				std::unique_lock lock {this->budget_mutex};
+
+				auto const wait_start = Clock::now();
+				this->budget_cv.wait(lock, [this, bytes] {
+					return this->buffered_bytes == 0 || this->buffered_bytes + bytes <= this->options.max_buffered_bytes;
+				});
+				stall_seconds += seconds_since(wait_start);
+
+				this->buffered_bytes += bytes;
+				this->stats.peak_buffered_bytes = std::max(this->stats.peak_buffered_bytes, this->buffered_bytes);
+			}
+
+			void release_budget(std::size_t bytes) {
+				{
+					std::lock_guard lock {this->budget_mutex};
+					this->buffered_bytes -= bytes;
+				}
+				this->budget_cv.notify_all();
+			}
+
+
+			void run_io_thread() {
+				LoaderStageStats read_stats;
+				double stall_seconds = 0.0;
+
+				for (;;) {
+					auto const file_idx = this->next_file_idx++;
+					if (file_idx >= this->paths.size()) {
+						break;
+					}
+
+					auto const start = Clock::now();
+					double file_stall_seconds = 0.0;
+					std::vector<std::byte> data;
+					std::size_t reserved_bytes = 0;
+
+					bool const read = read_file(this->paths[file_idx], data, reserved_bytes, [&] (std::size_t bytes) {
+						this->reserve_budget(bytes, file_stall_seconds);
+					});
+
+					stall_seconds += file_stall_seconds;
+					read_stats.busy_seconds += seconds_since(start) - file_stall_seconds;
+
+					if (!read) {
+						this->release_budget(reserved_bytes);
+						continue;
+					}
+
+					read_stats.files++;
+					read_stats.bytes += data.size();
+
+					{
+						std::lock_guard lock {this->queue_mutex};
+						this->queue.push_back(ReadFile{file_idx, std::move(data)});
+					}
+					this->queue_cv.notify_one();
+				}
+
+				{
+					std::lock_guard lock {this->queue_mutex};
+					this->running_io_threads--;
+				}
+				this->queue_cv.notify_all();
+
+				std::lock_guard lock {this->stats_mutex};
+				this->stats.read.files += read_stats.files;
+				this->stats.read.bytes += read_stats.bytes;
+				this->stats.read.busy_seconds += read_stats.busy_seconds;
+				this->stats.read_stall_seconds += stall_seconds;
+			}
+
+
+			void run_deserialize_thread() {
+				LoaderStageStats deserialize_stats;
+				std::size_t records = 0;
+
+				for (;;) {
+					ReadFile file;
+					{
+						std::unique_lock lock {this->queue_mutex};
+						this->queue_cv.wait(lock, [this] { return !this->queue.empty() || this->running_io_threads == 0; });
+
+						if (this->queue.empty()) {
+							break;
+						}
+
+						file = std::move(this->queue.front());
+						this->queue.pop_front();
+					}
+
+					auto const start = Clock::now();
+					auto const bytes = file.data.size();
+
+					if (this->deserialize_file(file)) {
+						deserialize_stats.files++;
+						deserialize_stats.bytes += bytes;
+						records += this->files[file.file_idx].instances.size();
+					}
+
+					// Free the file data before releasing its budget
+					file.data = {};
+					deserialize_stats.busy_seconds += seconds_since(start);
+					this->release_budget(bytes);
+				}
+
+				std::lock_guard lock {this->stats_mutex};
+				this->stats.deserialize.files += deserialize_stats.files;
+				this->stats.deserialize.bytes += deserialize_stats.bytes;
+				this->stats.deserialize.busy_seconds += deserialize_stats.busy_seconds;
+				this->stats.records += records;
+			}
+
+
+			bool deserialize_file(ReadFile const& read_file) {
+				auto const buffer = SerializedBuffer::open(read_file.data);
+				if (!buffer) {
+					return false;
+				}
+
+				auto const struct_it = this->structs_by_name.find(buffer->struct_name());
+				if (struct_it == this->structs_by_name.end()) {
+					return false;
+				}
+
+				// Files saved with another schema are migrated field by field, using the schema stored in the file
+				auto const& loadable = struct_it->second;
+				std::optional<MigrationPlan> migration;
+
+				if (buffer->header.fingerprint != loadable.fingerprint || buffer->header.record_stride != loadable.struct_def->size) {
+					auto const old_schema = buffer->schema();
+					if (!old_schema) {
+						return false;
+					}
+
+					migration = make_migration_plan(this->kernel, *old_schema, *loadable.struct_def);
+				}
+
+				auto& loaded_file = this->files[read_file.file_idx];
+				auto& instances = loaded_file.instances;
+				instances.resize(buffer->size());
+
+				StructPool* pool = nullptr;
+				{
+					std::lock_guard lock {this->pools_mutex};
+					pool = this->pools.pool_for(loadable.struct_def->id);
+					for (auto& instance : instances) {
+						instance = pool->create();
+					}
+				}
+
+				for (std::size_t record_idx = 0; record_idx < instances.size(); record_idx++) {
+					bool const read = migration
+						? migrate_record(*migration, *buffer, record_idx, instances[record_idx])
+						: deserialize_record(loadable.plan, *buffer, record_idx, instances[record_idx]);
+
+					if (!read) {
+						std::lock_guard lock {this->pools_mutex};
+						for (auto const instance : instances) {
+							pool->destroy(instance);
+						}
+
+						instances.clear();
+						return false;
+					}
+				}
+
+				loaded_file.struct_id = loadable.struct_def->id;
+				loaded_file.migrated = migration.has_value();
+				return true;
+			}
+		};
+	}
+
+
+	auto load_files(Kernel const& kernel, StructPools& pools, std::span<std::string const> paths, LoaderOptions options) -> LoadResult {
+		auto const start = Clock::now();
+
+		LoadPipeline pipeline {kernel, pools, paths, options};
+
+		for (auto const& struct_def : kernel.structs) {
+			auto plan = make_hash_plan(kernel, struct_def);
+			if (!can_serialize(plan)) {
+				continue;
+			}
+
+			pipeline.structs_by_name.emplace(struct_def.name, LoadableStruct {
+				&struct_def,
+				schema_fingerprint(kernel, struct_def),
+				std::move(plan),
+			});
+		}
+
+		pipeline.files.resize(paths.size());
+		for (std::size_t file_idx = 0; file_idx < paths.size(); file_idx++) {
+			pipeline.files[file_idx].path = paths[file_idx];
+		}
+
+		auto const io_thread_count = std::max<std::size_t>(options.io_threads, 1);
+		auto const deserialize_thread_count = std::max<std::size_t>(options.deserialize_threads, 1);
+		pipeline.running_io_threads = io_thread_count;
+
+		std::vector<std::thread> threads;
+		for (std::size_t idx = 0; idx < io_thread_count; idx++) {
+			threads.emplace_back([&pipeline] { pipeline.run_io_thread(); });
+		}
+		for (std::size_t idx = 0; idx < deserialize_thread_count; idx++) {
+			threads.emplace_back([&pipeline] { pipeline.run_deserialize_thread(); });
+		}
+
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		pipeline.stats.wall_seconds = seconds_since(start);
+
+		auto const failed_files = std::count_if(pipeline.files.begin(), pipeline.files.end(), [] (auto&& file) {
+			return !file.struct_id.has_value();
+		});
+
+		return LoadResult {std::move(pipeline.files), static_cast<std::size_t>(failed_files), pipeline.stats};
+	}
+
+
+
+	std::string format_debug(LoaderStats const& stats) {
+		auto const format_stage = [] (LoaderStageStats const& stage) {
+			return fmt::format("{} files, {} bytes in {:.3f}s busy ({:.1f} MB/s)", stage.files, stage.bytes, stage.busy_seconds,
+				stage.bytes_per_second() / 1e6);
+		};
+
+		std::string out;
+		fmt::format_to(std::back_inserter(out), "loaded {} records in {:.3f}s\n", stats.records, stats.wall_seconds);
+		fmt::format_to(std::back_inserter(out), "    read: {}\n", format_stage(stats.read));
+		fmt::format_to(std::back_inserter(out), "    deserialize: {}\n", format_stage(stats.deserialize));
+		fmt::format_to(std::back_inserter(out), "    read stalls: {:.3f}s, peak buffered: {} bytes\n", stats.read_stall_seconds,
+			stats.peak_buffered_bytes);
+		return out;
+	}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "property/property.h"
+#include "property/pool.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace property {
+
+	struct LoaderOptions {
+		std::size_t io_threads = 2;
+		std::size_t deserialize_threads = 2;
+		// Upper bound on file data that has been read but not yet deserialized. A single file larger than
+		// this is still loaded, on its own
+		std::size_t max_buffered_bytes = 64 * 1024 * 1024;
+	};
+
+
+	struct LoaderStageStats {
+		std::size_t files = 0;
+		std::size_t bytes = 0;
+		// Summed across the stage's threads
+		double busy_seconds = 0.0;
+
+		double bytes_per_second() const { return busy_seconds > 0.0 ? double(bytes) / busy_seconds : 0.0; }
+	};
+
+	struct LoaderStats {
+		LoaderStageStats read;
+		LoaderStageStats deserialize;
+		// Time I/O threads spent waiting for buffered data to drop below max_buffered_bytes
+		double read_stall_seconds = 0.0;
+		double wall_seconds = 0.0;
+		std::size_t peak_buffered_bytes = 0;
+		std::size_t records = 0;
+	};
+
+
+	struct LoadedFile {
+		std::string path;
+		// Empty if the file couldn't be read, isn't a serialized buffer, or its struct isn't registered
+		std::optional<StructId> struct_id;
+		// Instances constructed in the StructPools, in record order
+		std::vector<std::byte*> instances;
+		// Whether the file was saved with another schema, so was read with migrate_record. Only the fields
+		// make_migration_plan can migrate are loaded
+		bool migrated = false;
+	};
+
+	struct LoadResult {
+		// In the same order as the paths passed in
+		std::vector<LoadedFile> files;
+		std::size_t failed_files;
+		LoaderStats stats;
+	};
+
+
+	// Loads files written by serialize into instances in pools, with each struct's instances stored in its own pool.
+	// File reads and deserialization run concurrently: I/O threads read whole files with pread, and
+	// deserialize threads construct and fill instances as files arrive. Blocks until every file is loaded.
+	auto load_files(Kernel const& kernel, StructPools& pools, std::span<std::string const> paths, LoaderOptions options = {}) -> LoadResult;
+
+	std::string format_debug(LoaderStats const& stats);
+
+} // property
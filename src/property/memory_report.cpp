@@ -0,0 +1,185 @@
+#include "property/memory_report.h"
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+namespace property {
+
+	namespace {
+		void add_string(MemoryUsage& usage, std::string const& string) {
+			auto const object_begin = reinterpret_cast<std::byte const*>(&string);
+			auto const data = reinterpret_cast<std::byte const*>(string.data());
+
+			// Strings using the small string optimisation store their data inline
+			bool const is_inline = data >= object_begin && data < object_begin + sizeof(std::string);
+			if (!is_inline) {
+				usage.add(string.capacity() + 1);
+			}
+		}
+
+		template<class T>
+		void add_vector(MemoryUsage& usage, std::vector<T> const& vector) {
+			if (vector.capacity() > 0) {
+				usage.add(vector.capacity() * sizeof(T));
+			}
+		}
+
+		template<class T>
+		void add_deque(MemoryUsage& usage, std::deque<T> const& deque) {
+			// Assumes fixed size blocks of 512 bytes starting at the front element, plus a block map sized as when the
+			// deque was constructed. libstdc++ grows the map geometrically, so deques that outgrew it are underestimated
+			constexpr std::size_t block_bytes = 512;
+			constexpr std::size_t elements_per_block = sizeof(T) < block_bytes ? block_bytes / sizeof(T) : 1;
+
+			auto const block_count = deque.size() / elements_per_block + 1;
+			auto const map_size = std::max<std::size_t>(8, block_count + 2);
+
+			usage.add(map_size * sizeof(void*));
+			for (std::size_t block = 0; block < block_count; block++) {
+				usage.add(elements_per_block * sizeof(T));
+			}
+		}
+
+		template<class Map>
+		void add_unordered_map(MemoryUsage& usage, Map const& map) {
+			using value_type = typename Map::value_type;
+
+			// Assumes singly linked nodes without cached hash codes
+			constexpr std::size_t node_alignment = std::max(alignof(void*), alignof(value_type));
+			constexpr std::size_t node_bytes = (sizeof(void*) + sizeof(value_type) + node_alignment - 1) / node_alignment * node_alignment;
+
+			for (std::size_t node = 0; node < map.size(); node++) {
+				usage.add(node_bytes);
+			}
+
+			// A single bucket is stored inline
+			if (map.bucket_count() > 1) {
+				usage.add(map.bucket_count() * sizeof(void*));
+			}
+		}
+
+
+		auto struct_memory_report(StructDef const& struct_def) -> StructMemoryReport {
+			StructMemoryReport report {struct_def.id, struct_def.name, {}, {}, {}, {}};
+
+			add_vector(report.fields, struct_def.fields);
+			add_string(report.strings, struct_def.name);
+
+			for (auto const& field_def : struct_def.fields) {
+				add_string(report.strings, field_def.name);
+				add_string(report.strings, field_def.display_name);
+				add_string(report.strings, field_def.description);
+
+				add_vector(report.attributes, field_def.attributes.attributes);
+				for (auto const& attribute : field_def.attributes.attributes) {
+					report.attributes.add(attribute->allocation_size());
+				}
+			}
+
+			add_vector(report.other, struct_def.attribute_types);
+			add_vector(report.other, struct_def.contained_attribute_types);
+			add_vector(report.other, struct_def.nested_structs);
+			add_vector(report.other, struct_def.containing_structs);
+
+			// make_shared allocates the value alongside a control block of a vtable pointer and two counts,
+			// padded to the alignment of both
+			if (struct_def.default_value) {
+				auto const alignment = std::max(alignof(void*), struct_def.alignment);
+				auto const bytes = sizeof(void*) + 2 * sizeof(std::uint32_t) + struct_def.size;
+				report.other.add((bytes + alignment - 1) / alignment * alignment);
+			}
+
+			return report;
+		}
+	}
+
+
+	MemoryUsage StructMemoryReport::total() const {
+		MemoryUsage total;
+		total += this->fields;
+		total += this->strings;
+		total += this->attributes;
+		total += this->other;
+		return total;
+	}
+
+
+	MemoryUsage KernelMemoryReport::total() const {
+		MemoryUsage total;
+		total += this->structs;
+		total += this->fields;
+		total += this->strings;
+		total += this->attributes;
+		total += this->enums;
+		total += this->lookup_maps;
+		total += this->other;
+		return total;
+	}
+
+
+	auto Kernel::estimate_memory_usage() const -> KernelMemoryReport {
+		KernelMemoryReport report;
+
+		add_deque(report.structs, this->structs);
+
+		for (auto const& struct_def : this->structs) {
+			auto struct_report = struct_memory_report(struct_def);
+
+			report.fields += struct_report.fields;
+			report.strings += struct_report.strings;
+			report.attributes += struct_report.attributes;
+			report.other += struct_report.other;
+
+			report.per_struct.push_back(std::move(struct_report));
+		}
+
+		add_deque(report.enums, this->enums);
+
+		for (auto const& enum_def : this->enums) {
+			add_string(report.enums, enum_def.name);
+			add_vector(report.enums, enum_def.variants);
+			add_vector(report.enums, enum_def.variants_by_name);
+
+			for (auto const& variant_def : enum_def.variants) {
+				add_string(report.enums, variant_def.display_name);
+			}
+		}
+
+		add_unordered_map(report.lookup_maps, this->type_id_to_struct);
+		add_unordered_map(report.lookup_maps, this->type_id_to_enum);
+		add_unordered_map(report.lookup_maps, this->attribute_index);
+
+		for (auto const& [_, entries] : this->attribute_index) {
+			add_vector(report.lookup_maps, entries);
+		}
+
+		return report;
+	}
+
+
+
+	std::string format_debug(KernelMemoryReport const& report) {
+		auto const format_usage = [] (MemoryUsage const& usage) {
+			return fmt::format("{} bytes in {} allocations", usage.bytes, usage.allocations);
+		};
+
+		std::string out;
+		fmt::format_to(std::back_inserter(out), "total: {}\n", format_usage(report.total()));
+		fmt::format_to(std::back_inserter(out), "    structs: {}\n", format_usage(report.structs));
+		fmt::format_to(std::back_inserter(out), "    fields: {}\n", format_usage(report.fields));
+		fmt::format_to(std::back_inserter(out), "    strings: {}\n", format_usage(report.strings));
+		fmt::format_to(std::back_inserter(out), "    attributes: {}\n", format_usage(report.attributes));
+		fmt::format_to(std::back_inserter(out), "    enums: {}\n", format_usage(report.enums));
+		fmt::format_to(std::back_inserter(out), "    lookup maps: {}\n", format_usage(report.lookup_maps));
+		fmt::format_to(std::back_inserter(out), "    other: {}\n", format_usage(report.other));
+
+		for (auto const& struct_report : report.per_struct) {
+			fmt::format_to(std::back_inserter(out), "struct \"{}\" (id: {}): {}\n", struct_report.name, struct_report.id,
+				format_usage(struct_report.total()));
+		}
+
+		return out;
+	}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace property {
+
+	struct MemoryUsage {
+		std::size_t bytes = 0;
+		std::size_t allocations = 0;
+
+		void add(std::size_t allocation_bytes) {
+			this->bytes += allocation_bytes;
+			this->allocations++;
+		}
+
+		MemoryUsage& operator+=(MemoryUsage const& other) {
+			this->bytes += other.bytes;
+			this->allocations += other.allocations;
+			return *this;
+		}
+	};
+
+
+	struct StructMemoryReport {
+		StructId id;
+		std::string_view name;
+
+		// Field storage, including each FieldDef's inline ListFieldInfo
+		MemoryUsage fields;
+		// Heap allocated names, display names and descriptions. Strings short enough for SSO cost nothing extra
+		MemoryUsage strings;
+		MemoryUsage attributes;
+		// The default value instance and its control block, plus the attribute summaries
+		MemoryUsage other;
+
+		MemoryUsage total() const;
+	};
+
+
+	// Estimated heap usage of a Kernel's reflection metadata, in bytes requested from the allocator, as returned
+	// by Kernel::estimate_memory_usage. Only vector and string storage is counted exactly, from capacities.
+	// Hash map nodes, deque blocks and maps, and shared_ptr control blocks aren't observable, so they're estimated
+	// from a simplified libstdc++ layout, and will differ on other standard libraries and for grown deques.
+	// None of the figures include the allocator's own per allocation overhead.
+	// Plans cached by the Kernel, e.g., by hash_plan_for, aren't counted.
+	struct KernelMemoryReport {
+		// StructDef storage within Kernel::structs
+		MemoryUsage structs;
+		MemoryUsage fields;
+		MemoryUsage strings;
+		MemoryUsage attributes;
+		MemoryUsage enums;
+		MemoryUsage lookup_maps;
+		MemoryUsage other;
+
+		std::vector<StructMemoryReport> per_struct;
+
+		MemoryUsage total() const;
+	};
+
+	std::string format_debug(KernelMemoryReport const& report);
+
+} // property
@@ -0,0 +1,324 @@
+#include "property/packed.h"
+#include "property/internal/value_access.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace property {
+
+	namespace {
+		std::uint64_t low_bits_mask(std::uint32_t bit_width) {
+			return bit_width >= 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << bit_width) - 1;
+		}
+
+
+		// Values never straddle more than two words, as bit widths are at most 32
+		std::uint64_t extract_bits(std::uint64_t const* words, std::size_t bit_pos, std::uint32_t bit_width, std::uint64_t mask) {
+			auto const word = bit_pos / 64;
+			auto const shift = bit_pos % 64;
+
+			auto bits = words[word] >> shift;
+			if (shift + bit_width > 64) {
+				bits |= words[word + 1] << (64 - shift);
+			}
+
+			return bits & mask;
+		}
+
+
+		std::size_t column_words(std::size_t count, std::uint32_t bit_width) {
+			// A spare word, so that reads never need to check whether a value straddles the end
+			return (count * bit_width + 63) / 64 + 1;
+		}
+
+
+		void collect_packed_fields(Kernel const& kernel, StructDef const& struct_def, std::uint32_t base_offset, std::string const& prefix,
+			PackedOptions options, internal::PackedRangeFn range_fn, PackedLayout& layout)
+		{
+			for (auto const& field_def : struct_def.fields) {
+				auto const& field_info = field_def.field_info;
+				auto path = prefix + field_def.name;
+				auto const offset = base_offset + static_cast<std::uint32_t>(field_info.offset);
+				auto const size = static_cast<std::uint32_t>(field_info.size);
+
+				if (field_def.list_info) {
+					layout.skipped_fields.push_back(std::move(path));
+					continue;
+				}
+
+				if (auto struct_id = kernel.struct_id_from_type_id(field_info.type_id)) {
+					collect_packed_fields(kernel, *kernel.struct_def_for(*struct_id), offset, path + "/", options, range_fn, layout);
+					continue;
+				}
+
+				PackedFieldCodec codec {path, field_info.type_id, offset, size, PackedFieldCodec::Kind::Raw, size * 8, 0, 0, 0.0, 0.0};
+
+				auto const set_int_range = [&codec] (std::int64_t min, std::int64_t max) {
+					codec.kind = PackedFieldCodec::Kind::Int;
+					codec.int_min = min;
+					codec.int_max = max;
+					codec.bit_width = static_cast<std::uint32_t>(std::bit_width(static_cast<std::uint64_t>(max - min)));
+				};
+
+				// An empty range when there's no attribute
+				auto const [range_min, range_max] = (range_fn ? range_fn(field_def) : std::nullopt).value_or(std::pair{1.0, 0.0});
+				bool const has_range = range_min <= range_max;
+				auto const enum_id = kernel.enum_id_from_type_id(field_info.type_id);
+
+				if (field_info.type_id == TypeId::Int && has_range) {
+					set_int_range(static_cast<std::int64_t>(std::ceil(range_min)), static_cast<std::int64_t>(std::floor(range_max)));
+
+				} else if (field_info.type_id == TypeId::Float && has_range) {
+					auto const float_bits = std::clamp<std::uint32_t>(options.float_bits, 1, 32);
+					bool const single_value = range_min == range_max;
+
+					codec.kind = PackedFieldCodec::Kind::Float;
+					codec.bit_width = single_value ? 0 : float_bits;
+					codec.float_min = range_min;
+					codec.float_step = single_value ? 0.0 : (range_max - range_min) / double(low_bits_mask(float_bits));
+
+				} else if (enum_id && !kernel.enum_def_for(*enum_id)->variants.empty()) {
+					auto const& variants = kernel.enum_def_for(*enum_id)->variants;
+					auto const [min_it, max_it] = std::minmax_element(variants.begin(), variants.end(), [] (auto&& lhs, auto&& rhs) {
+						return lhs.value < rhs.value;
+					});
+					set_int_range(min_it->value, max_it->value);
+
+				} else if (field_info.type_id != TypeId::Int && field_info.type_id != TypeId::Float && !enum_id) {
+					layout.skipped_fields.push_back(std::move(path));
+					continue;
+				}
+
+				// Keeps every value within two words of a column
+				if (codec.bit_width > 32) {
+					layout.skipped_fields.push_back(std::move(path));
+					continue;
+				}
+
+				layout.fields.push_back(std::move(codec));
+			}
+		}
+	}
+
+
+	std::uint64_t PackedFieldCodec::encode(std::byte const* field_ptr) const {
+		switch (this->kind) {
+			case Kind::Int: {
+				auto const value = std::clamp(internal::read_signed(field_ptr, this->size), this->int_min, this->int_max);
+				return static_cast<std::uint64_t>(value - this->int_min);
+			}
+
+			case Kind::Float: {
+				float value;
+				std::memcpy(&value, field_ptr, sizeof value);
+
+				// Also catches NaN
+				if (!(value > this->float_min) || this->float_step == 0.0) {
+					return 0;
+				}
+
+				auto const steps = std::round((value - this->float_min) / this->float_step);
+				return std::min(static_cast<std::uint64_t>(std::min(steps, 4294967295.0)), low_bits_mask(this->bit_width));
+			}
+
+			case Kind::Raw: {
+				std::uint32_t bits = 0;
+				std::memcpy(&bits, field_ptr, this->size);
+				return bits;
+			}
+		}
+
+		return 0;
+	}
+
+
+	void PackedFieldCodec::decode(std::uint64_t bits, std::byte* field_ptr) const {
+		switch (this->kind) {
+			case Kind::Int: {
+				internal::write_signed(this->int_min + static_cast<std::int64_t>(bits), this->size, field_ptr);
+				break;
+			}
+
+			case Kind::Float: {
+				// Matches the float arithmetic of PackedStructArray::unpack
+				auto const value = static_cast<float>(this->float_min) + static_cast<float>(bits) * static_cast<float>(this->float_step);
+				std::memcpy(field_ptr, &value, sizeof value);
+				break;
+			}
+
+			case Kind::Raw: {
+				auto const raw = static_cast<std::uint32_t>(bits);
+				std::memcpy(field_ptr, &raw, this->size);
+				break;
+			}
+		}
+	}
+
+
+
+	std::size_t PackedLayout::bits_per_instance() const {
+		std::size_t bits = 0;
+		for (auto const& codec : this->fields) {
+			bits += codec.bit_width;
+		}
+		return bits;
+	}
+
+
+	auto internal::make_packed_layout(Kernel const& kernel, StructDef const& struct_def, PackedOptions options, PackedRangeFn range_fn) -> PackedLayout {
+		PackedLayout layout {&struct_def, {}, {}};
+		collect_packed_fields(kernel, struct_def, 0, "", options, range_fn, layout);
+		return layout;
+	}
+
+
+	auto make_packed_layout(Kernel const& kernel, StructDef const& struct_def, PackedOptions options) -> PackedLayout {
+		return internal::make_packed_layout(kernel, struct_def, options, nullptr);
+	}
+
+
+
+	void PackedStructArray::resize(std::size_t new_count) {
+		for (std::size_t column = 0; column < this->columns.size(); column++) {
+			this->columns[column].resize(column_words(new_count, this->layout.fields[column].bit_width));
+		}
+
+		// Clear bits beyond the new end, so that growing again yields zeroed values
+		if (new_count < this->count) {
+			for (std::size_t column = 0; column < this->columns.size(); column++) {
+				auto const bit_width = this->layout.fields[column].bit_width;
+				auto& words = this->columns[column];
+
+				auto const end_bit = new_count * bit_width;
+				auto const first_clear_word = (end_bit + 63) / 64;
+				if (end_bit % 64 != 0) {
+					words[end_bit / 64] &= low_bits_mask(end_bit % 64);
+				}
+				std::fill(words.begin() + first_clear_word, words.end(), 0);
+			}
+		}
+
+		this->count = new_count;
+	}
+
+
+	void PackedStructArray::pack(StructSpan instances, std::size_t first_idx) {
+		if (first_idx + instances.count > this->count) {
+			this->resize(first_idx + instances.count);
+		}
+
+		auto const stride = instances.struct_def->size;
+
+		for (std::uint32_t column = 0; column < this->columns.size(); column++) {
+			auto const& codec = this->layout.fields[column];
+			if (codec.bit_width == 0) {
+				continue;
+			}
+
+			for (std::size_t idx = 0; idx < instances.count; idx++) {
+				this->write_bits(column, first_idx + idx, codec.encode(instances.data + idx * stride + codec.offset));
+			}
+		}
+	}
+
+
+	void PackedStructArray::push_back(std::byte const* struct_ptr) {
+		this->pack(StructSpan{this->layout.struct_def, struct_ptr, 1}, this->count);
+	}
+
+
+	void PackedStructArray::unpack(StructMutSpan instances, std::size_t first_idx) const {
+		auto const stride = instances.struct_def->size;
+		auto const count = std::min(instances.count, this->count - std::min(first_idx, this->count));
+
+		// Decodes a column at a time, with the common int and float cases inlined rather than going through decode
+		for (std::size_t column = 0; column < this->columns.size(); column++) {
+			auto const& codec = this->layout.fields[column];
+			auto const words = this->columns[column].data();
+			auto const bit_width = codec.bit_width;
+			auto const mask = low_bits_mask(bit_width);
+			auto const dst = instances.data + codec.offset;
+
+			if (codec.kind == PackedFieldCodec::Kind::Int && codec.size == 4) {
+				for (std::size_t idx = 0; idx < count; idx++) {
+					auto const bits = extract_bits(words, (first_idx + idx) * bit_width, bit_width, mask);
+					auto const value = static_cast<std::int32_t>(codec.int_min + static_cast<std::int64_t>(bits));
+					std::memcpy(dst + idx * stride, &value, sizeof value);
+				}
+
+			} else if (codec.kind == PackedFieldCodec::Kind::Float) {
+				auto const min = static_cast<float>(codec.float_min);
+				auto const step = static_cast<float>(codec.float_step);
+
+				for (std::size_t idx = 0; idx < count; idx++) {
+					auto const bits = extract_bits(words, (first_idx + idx) * bit_width, bit_width, mask);
+					auto const value = min + static_cast<float>(bits) * step;
+					std::memcpy(dst + idx * stride, &value, sizeof value);
+				}
+
+			} else {
+				for (std::size_t idx = 0; idx < count; idx++) {
+					codec.decode(extract_bits(words, (first_idx + idx) * bit_width, bit_width, mask), dst + idx * stride);
+				}
+			}
+		}
+	}
+
+
+	auto PackedStructArray::field(Kernel const& kernel, std::string_view field_path) const -> std::optional<PackedField> {
+		auto const compiled_path = compile_field_path(kernel, this->layout.struct_def, field_path);
+		if (!compiled_path) {
+			return std::nullopt;
+		}
+
+		auto const type_id = compiled_path->field_def->field_info.type_id;
+		for (std::uint32_t column = 0; column < this->layout.fields.size(); column++) {
+			auto const& codec = this->layout.fields[column];
+			if (codec.offset == compiled_path->offset && codec.type_id == type_id) {
+				return PackedField{column};
+			}
+		}
+
+		return std::nullopt;
+	}
+
+
+	std::size_t PackedStructArray::memory_bytes() const {
+		std::size_t bytes = 0;
+		for (auto const& words : this->columns) {
+			bytes += words.size() * sizeof(std::uint64_t);
+		}
+		return bytes;
+	}
+
+
+	std::uint64_t PackedStructArray::read_bits(std::uint32_t column, std::size_t idx) const {
+		auto const bit_width = this->layout.fields[column].bit_width;
+		return extract_bits(this->columns[column].data(), idx * bit_width, bit_width, low_bits_mask(bit_width));
+	}
+
+
+	void PackedStructArray::write_bits(std::uint32_t column, std::size_t idx, std::uint64_t bits) {
+		auto const bit_width = this->layout.fields[column].bit_width;
+		if (bit_width == 0) {
+			return;
+		}
+
+		auto& words = this->columns[column];
+		auto const mask = low_bits_mask(bit_width);
+		auto const bit_pos = idx * bit_width;
+		auto const word = bit_pos / 64;
+		auto const shift = bit_pos % 64;
+
+		bits &= mask;
+		words[word] = (words[word] & ~(mask << shift)) | (bits << shift);
+
+		if (shift + bit_width > 64) {
+			auto const high_shift = 64 - shift;
+			words[word + 1] = (words[word + 1] & ~(mask >> high_shift)) | (bits >> high_shift);
+		}
+	}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace property {
+
+	struct PackedOptions {
+		// Bits per float field with a range. Floats without a range are stored exactly
+		std::uint32_t float_bits = 16;
+	};
+
+
+	// How one numeric field is stored in a PackedStructArray column
+	struct PackedFieldCodec {
+		enum class Kind {
+			// Stored as value - int_min, with values outside the range clamped
+			Int,
+			// Quantized to bit_width bits between float_min and float_min + float_step * (2^bit_width - 1)
+			Float,
+			// The field's bytes, unchanged
+			Raw,
+		};
+
+		std::string path;
+		TypeId type_id;
+		std::uint32_t offset;
+		std::uint32_t size;
+		Kind kind;
+		// Zero for fields whose range holds a single value, which take no storage
+		std::uint32_t bit_width;
+
+		std::int64_t int_min;
+		std::int64_t int_max;
+		double float_min;
+		double float_step;
+
+		std::uint64_t encode(std::byte const* field_ptr) const;
+		void decode(std::uint64_t bits, std::byte* field_ptr) const;
+	};
+
+
+	// The packed representation of a registered struct: a codec per int, float and enum field, including
+	// those in nested structs. Bit widths come from range attributes and enum variants.
+	struct PackedLayout {
+		StructDef const* struct_def;
+		std::vector<PackedFieldCodec> fields;
+		// Paths of string, list and other fields that aren't stored, e.g., "whatever"
+		std::vector<std::string> skipped_fields;
+
+		std::size_t bits_per_instance() const;
+	};
+
+
+	namespace internal {
+		using PackedRangeFn = std::optional<std::pair<double, double>> (*)(FieldDef const&);
+
+		auto make_packed_layout(Kernel const&, StructDef const&, PackedOptions, PackedRangeFn) -> PackedLayout;
+	}
+
+	auto make_packed_layout(Kernel const& kernel, StructDef const& struct_def, PackedOptions options = {}) -> PackedLayout;
+
+	// Narrows fields to the bounds of Range<float>/Range<int> attributes, e.g., make_packed_layout<RangeAttribute>(...).
+	// Range<T> must have min and max members
+	template<template<class> class Range>
+	auto make_packed_layout(Kernel const& kernel, StructDef const& struct_def, PackedOptions options = {}) -> PackedLayout;
+
+
+	// A field of a PackedStructArray, resolved once from a path
+	struct PackedField {
+		std::uint32_t column;
+	};
+
+
+	// Instances of a registered struct stored as one bit-packed column per field.
+	// Packing and unpacking go a column at a time. Fields the layout skips are left untouched by unpack,
+	// so the destination must hold constructed instances.
+	struct PackedStructArray {
+		PackedStructArray(PackedLayout layout) : layout{std::move(layout)}, columns(this->layout.fields.size()) {}
+
+		auto size() const { return count; }
+		void resize(std::size_t new_count);
+
+		// Packs instances into [first_idx, first_idx + instances.count), growing the array as needed
+		void pack(StructSpan instances, std::size_t first_idx = 0);
+		void push_back(std::byte const* struct_ptr);
+		// Unpacks [first_idx, first_idx + instances.count) into instances
+		void unpack(StructMutSpan instances, std::size_t first_idx = 0) const;
+
+		// Returns nullopt if the path doesn't name a stored field
+		auto field(Kernel const& kernel, std::string_view field_path) const -> std::optional<PackedField>;
+
+		// Returns nullopt/false if T isn't the field's type
+		template<class T>
+		std::optional<T> try_get(PackedField field, std::size_t idx) const;
+		template<class T>
+		bool try_set(PackedField field, std::size_t idx, T const& value);
+
+		// Bytes used by the packed columns
+		std::size_t memory_bytes() const;
+
+		PackedLayout layout;
+
+	private:
+		std::uint64_t read_bits(std::uint32_t column, std::size_t idx) const;
+		void write_bits(std::uint32_t column, std::size_t idx, std::uint64_t bits);
+
+		std::size_t count = 0;
+		std::vector<std::vector<std::uint64_t>> columns;
+	};
+
+} // property
+
+
+#include "property/packed.inl"
@@ -0,0 +1,46 @@
+namespace property {
+
+	template<template<class> class Range>
+	auto make_packed_layout(Kernel const& kernel, StructDef const& struct_def, PackedOptions options) -> PackedLayout {
+		auto const range_fn = [] (FieldDef const& field_def) -> std::optional<std::pair<double, double>> {
+			if (auto range = field_def.attributes.get_attribute<Range<float>>()) {
+				return std::pair{double(range->min), double(range->max)};
+			}
+
+			if (auto range = field_def.attributes.get_attribute<Range<int>>()) {
+				return std::pair{double(range->min), double(range->max)};
+			}
+
+			return std::nullopt;
+		};
+
+		return internal::make_packed_layout(kernel, struct_def, options, range_fn);
+	}
+
+
+
+	template<class T>
+	std::optional<T> PackedStructArray::try_get(PackedField field, std::size_t idx) const {
+		auto const& codec = this->layout.fields[field.column];
+		if (codec.type_id != type_id<T>() || codec.size != sizeof(T)) {
+			return std::nullopt;
+		}
+
+		T value;
+		codec.decode(this->read_bits(field.column, idx), reinterpret_cast<std::byte*>(&value));
+		return value;
+	}
+
+
+	template<class T>
+	bool PackedStructArray::try_set(PackedField field, std::size_t idx, T const& value) {
+		auto const& codec = this->layout.fields[field.column];
+		if (codec.type_id != type_id<T>() || codec.size != sizeof(T)) {
+			return false;
+		}
+
+		this->write_bits(field.column, idx, codec.encode(reinterpret_cast<std::byte const*>(&value)));
+		return true;
+	}
+
+} // property
@@ -0,0 +1,268 @@
+#include "property/parse.h"
+#include "property/internal/value_access.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace property {
+
+	namespace {
+		std::string_view trim(std::string_view text) {
+			auto const is_space = [] (char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+
+			while (!text.empty() && is_space(text.front())) {
+				text.remove_prefix(1);
+			}
+
+			while (!text.empty() && is_space(text.back())) {
+				text.remove_suffix(1);
+			}
+
+			return text;
+		}
+
+
+		template<class T>
+		bool parse_and_store(std::string_view text, std::byte* ptr) {
+			T value;
+			if (!internal::parse_number(text, value)) {
+				return false;
+			}
+
+			std::memcpy(ptr, &value, sizeof value);
+			return true;
+		}
+
+
+		// Splits "a, {b, c}, [d]" on top level commas
+		template<class F>
+		bool for_each_item(std::string_view text, char open, char close, F&& func) {
+			text = trim(text);
+			if (text.size() < 2 || text.front() != open || text.back() != close) {
+				return false;
+			}
+
+			text = trim(text.substr(1, text.size() - 2));
+			if (text.empty()) {
+				return true;
+			}
+
+			int depth = 0;
+			bool in_quotes = false;
+			std::size_t item_begin = 0;
+
+			for (std::size_t idx = 0; idx <= text.size(); idx++) {
+				if (idx == text.size() || (text[idx] == ',' && depth == 0 && !in_quotes)) {
+					if (!func(trim(text.substr(item_begin, idx - item_begin)))) {
+						return false;
+					}
+
+					item_begin = idx + 1;
+					continue;
+				}
+
+				switch (text[idx]) {
+					case '"': in_quotes = !in_quotes; break;
+					case '{': case '[': depth += in_quotes ? 0 : 1; break;
+					case '}': case ']': depth -= in_quotes ? 0 : 1; break;
+					default: break;
+				}
+			}
+
+			return true;
+		}
+
+
+		bool parse_value(Kernel const& kernel, TypeId type_id, std::size_t size, ListFieldInfo const* list_info,
+			std::byte* ptr, std::string_view text);
+
+
+		bool parse_struct(Kernel const& kernel, StructDef const& struct_def, std::byte* struct_ptr, std::string_view text) {
+			return for_each_item(text, '{', '}', [&] (std::string_view item) {
+				auto const [name, value] = split(item, '=');
+				auto const field_name = trim(name);
+
+				auto const field_it = std::find_if(
+					struct_def.fields.begin(), struct_def.fields.end(),
+					[field_name] (auto&& field_def) { return field_def.name == field_name; }
+				);
+
+				if (field_it == struct_def.fields.end()) {
+					return false;
+				}
+
+				auto const& field_info = field_it->field_info;
+				auto const list_info = field_it->list_info ? &*field_it->list_info : nullptr;
+				return parse_value(kernel, field_info.type_id, field_info.size, list_info, struct_ptr + field_info.offset, value);
+			});
+		}
+
+
+		bool parse_list(Kernel const& kernel, ListFieldInfo const& list_info, std::byte* field_ptr, std::string_view text) {
+			std::size_t element_count = 0;
+			if (!for_each_item(text, '[', ']', [&element_count] (std::string_view) { element_count++; return true; })) {
+				return false;
+			}
+
+			if (!list_info.resize(field_ptr, element_count)) {
+				return false;
+			}
+
+			std::size_t element_idx = 0;
+			return for_each_item(text, '[', ']', [&] (std::string_view item) {
+				auto const element_ptr = list_info.get_element_ptr(field_ptr, element_idx++);
+				return parse_value(kernel, list_info.element_type_id, list_info.element_size, nullptr, element_ptr, item);
+			});
+		}
+
+
+		bool parse_enum(EnumDef const& enum_def, std::size_t size, std::byte* ptr, std::string_view text) {
+			// Accept qualified names, e.g., "Wamp::B"
+			auto const name = internal::unqualified_name(text, enum_def.name);
+			if (!name) {
+				return false;
+			}
+
+			if (auto variant = enum_def.find_variant(*name)) {
+				return internal::write_signed(variant->value, size, ptr);
+			}
+
+			// Numbers must be the value of a variant, which also keeps them in range of the enum's size
+			std::int64_t value;
+			if (!internal::parse_number(*name, value)) {
+				return false;
+			}
+
+			auto const variant_it = std::find_if(enum_def.variants.begin(), enum_def.variants.end(), [value] (auto&& variant_def) {
+				return variant_def.value == value;
+			});
+
+			return variant_it != enum_def.variants.end() && internal::write_signed(variant_it->value, size, ptr);
+		}
+
+
+		bool parse_value(Kernel const& kernel, TypeId type_id, std::size_t size, ListFieldInfo const* list_info,
+			std::byte* ptr, std::string_view text)
+		{
+			text = trim(text);
+
+			if (list_info) {
+				return parse_list(kernel, *list_info, ptr, text);
+			}
+
+			switch (type_id) {
+				case TypeId::Int: return parse_and_store<int>(text, ptr);
+				case TypeId::Float: return parse_and_store<float>(text, ptr);
+
+				case TypeId::String: {
+					if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+						text = text.substr(1, text.size() - 2);
+					}
+
+					internal::read_string_mut(ptr).assign(text);
+					return true;
+				}
+
+				default: break;
+			}
+
+			if (auto struct_id = kernel.struct_id_from_type_id(type_id)) {
+				return parse_struct(kernel, *kernel.struct_def_for(*struct_id), ptr, text);
+			}
+
+			if (auto enum_id = kernel.enum_id_from_type_id(type_id)) {
+				return parse_enum(*kernel.enum_def_for(*enum_id), size, ptr, text);
+			}
+
+			return false;
+		}
+
+
+		struct StringViewHash {
+			using is_transparent = void;
+			std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+		};
+	}
+
+
+	bool parse_field(Kernel const& kernel, FieldMutRef field_ref, std::string_view text) {
+		auto const field_def = field_ref.field_def;
+		auto const list_info = field_def->list_info ? &*field_def->list_info : nullptr;
+
+		return parse_value(kernel, field_def->field_info.type_id, field_def->field_info.size, list_info,
+			field_ref.field_ptr, text);
+	}
+
+
+
+	auto load_records(Kernel const& kernel, StructMutSpan records, std::string_view text) -> RecordLoadResult {
+		RecordLoadResult result {0, 0, std::nullopt, false};
+
+		std::unordered_map<std::string, std::optional<CompiledFieldPath>, StringViewHash, std::equal_to<>> path_cache;
+
+		std::size_t line_number = 0;
+		bool record_started = false;
+
+		auto const report_error = [&result, &line_number] {
+			result.error_count++;
+			if (!result.first_error_line) {
+				result.first_error_line = line_number;
+			}
+		};
+
+		while (!text.empty()) {
+			auto const line_end = text.find('\n');
+			auto const line = trim(text.substr(0, line_end));
+			text.remove_prefix(line_end == std::string_view::npos ? text.size() : line_end + 1);
+			line_number++;
+
+			if (line.empty()) {
+				if (record_started) {
+					result.record_count++;
+					record_started = false;
+				}
+				continue;
+			}
+
+			if (line.front() == '#') {
+				continue;
+			}
+
+			if (!record_started && result.record_count >= records.count) {
+				result.truncated = true;
+				break;
+			}
+
+			record_started = true;
+
+			auto const [path, value] = split(line, '=');
+			auto const field_path = trim(path);
+
+			auto cache_it = path_cache.find(field_path);
+			if (cache_it == path_cache.end()) {
+				auto compiled_path = compile_field_path(kernel, records.struct_def, field_path);
+				cache_it = path_cache.emplace(std::string{field_path}, std::move(compiled_path)).first;
+			}
+
+			auto const& compiled_path = cache_it->second;
+			if (!compiled_path) {
+				report_error();
+				continue;
+			}
+
+			auto const field_ref = compiled_path->resolve(records[result.record_count].struct_ptr);
+			if (!parse_field(kernel, field_ref, value)) {
+				report_error();
+			}
+		}
+
+		if (record_started) {
+			result.record_count++;
+		}
+
+		return result;
+	}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <optional>
+#include <string_view>
+
+namespace property {
+
+	// Sets a field from text; the inverse of FieldTypeInfo::format.
+	// Numbers are parsed with std::from_chars, enums by variant name (optionally qualified with the enum's
+	// name, e.g., "Wamp::B") or the value of a variant, strings are taken verbatim with optional surrounding quotes, nested structs as
+	// "{field = value, ...}" and lists as "[value, ...]".
+	// Returns false if the text couldn't be parsed, in which case the field may be partially written.
+	bool parse_field(Kernel const& kernel, FieldMutRef field_ref, std::string_view text);
+
+
+	struct RecordLoadResult {
+		std::size_t record_count;
+		std::size_t error_count;
+		// 1-based line number of the first line that failed to parse
+		std::optional<std::size_t> first_error_line;
+		// text contained more records than would fit
+		bool truncated;
+	};
+
+	// Loads records in a simple text format into consecutive instances:
+	//
+	//     a_field = 5
+	//     a_blah/meh = 2.5
+	//
+	//     a_field = 6
+	//
+	// Each line sets one field path, blank lines separate records and lines starting with '#' are ignored.
+	// Each distinct path is resolved once, no matter how many records use it.
+	auto load_records(Kernel const& kernel, StructMutSpan records, std::string_view text) -> RecordLoadResult;
+
+} // property
@@ -0,0 +1,254 @@
+#include "property/pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace property {
+
+	StructPool::StructPool(StructDef const* struct_def, std::size_t instances_per_slab)
+		: struct_def {struct_def}
+		, instances_per_slab {instances_per_slab}
+		, slab_alignment {std::max(cache_line_size, struct_def->alignment)}
+	{
+		if (this->instances_per_slab == 0) {
+			this->instances_per_slab = std::max<std::size_t>(default_slab_bytes / std::max<std::size_t>(struct_def->size, 1), 1);
+		}
+	}
+
+
+	StructPool::~StructPool() {
+		this->release();
+	}
+
+
+	StructPool::StructPool(StructPool&& other)
+		: struct_def {other.struct_def}
+		, instances_per_slab {other.instances_per_slab}
+		, slab_alignment {other.slab_alignment}
+		, live_count {std::exchange(other.live_count, 0)}
+		, slabs {std::move(other.slabs)}
+		, slabs_by_address {std::move(other.slabs_by_address)}
+		, free_slots {std::move(other.free_slots)}
+	{
+		other.slabs.clear();
+		other.slabs_by_address.clear();
+		other.free_slots.clear();
+	}
+
+
+	StructPool& StructPool::operator=(StructPool&& other) {
+		if (this != &other) {
+			this->release();
+
+			this->struct_def = other.struct_def;
+			this->instances_per_slab = other.instances_per_slab;
+			this->slab_alignment = other.slab_alignment;
+			this->live_count = std::exchange(other.live_count, 0);
+			this->slabs = std::move(other.slabs);
+			this->slabs_by_address = std::move(other.slabs_by_address);
+			this->free_slots = std::move(other.free_slots);
+
+			other.slabs.clear();
+			other.slabs_by_address.clear();
+			other.free_slots.clear();
+		}
+
+		return *this;
+	}
+
+
+
+	std::byte* StructPool::create() {
+		auto const instance = this->allocate_slot();
+		this->struct_def->lifecycle.default_construct(instance);
+		return instance;
+	}
+
+
+	std::byte* StructPool::create_copy(std::byte const* src) {
+		auto const copy_construct = this->struct_def->lifecycle.copy_construct;
+		if (!copy_construct) {
+			return nullptr;
+		}
+
+		auto const instance = this->allocate_slot();
+		copy_construct(instance, src);
+		return instance;
+	}
+
+
+	void StructPool::destroy(std::byte* instance) {
+		auto const location = this->locate(instance);
+		if (!location) {
+			return;
+		}
+
+		auto& live_word = this->slabs[location->slab_idx].live_bits[location->slot_idx / 64];
+		auto const live_mask = std::uint64_t{1} << (location->slot_idx % 64);
+
+		if ((live_word & live_mask) == 0) {
+			return;
+		}
+
+		if (!this->struct_def->lifecycle.trivially_destructible) {
+			this->struct_def->lifecycle.destroy(instance);
+		}
+
+		live_word &= ~live_mask;
+		this->live_count--;
+		this->free_slots.push_back(instance);
+	}
+
+
+	void StructPool::reset_to_default(std::byte* instance) const {
+		auto const default_ptr = this->struct_def->default_value.get();
+
+		if (this->struct_def->lifecycle.trivially_copyable) {
+			std::memcpy(instance, default_ptr, this->struct_def->size);
+		} else if (this->struct_def->lifecycle.copy_assign) {
+			this->struct_def->lifecycle.copy_assign(instance, default_ptr);
+		} else {
+			this->struct_def->lifecycle.destroy(instance);
+			this->struct_def->lifecycle.default_construct(instance);
+		}
+	}
+
+
+	void StructPool::reset_all_to_default() {
+		this->for_each([this] (std::byte* instance) {
+			this->reset_to_default(instance);
+		});
+	}
+
+
+	void StructPool::clear() {
+		this->destroy_live_instances();
+		this->free_slots.clear();
+
+		auto const stride = this->struct_def->size;
+
+		// Hand out lower addresses first so that refilled pools stay dense
+		for (auto slab_it = this->slabs.rbegin(); slab_it != this->slabs.rend(); ++slab_it) {
+			for (std::size_t slot_idx = this->instances_per_slab; slot_idx-- > 0;) {
+				this->free_slots.push_back(slab_it->data + slot_idx * stride);
+			}
+		}
+	}
+
+
+	void StructPool::release() {
+		this->destroy_live_instances();
+
+		for (auto& slab : this->slabs) {
+			::operator delete(slab.data, std::align_val_t{this->slab_alignment});
+		}
+
+		this->slabs.clear();
+		this->slabs_by_address.clear();
+		this->free_slots.clear();
+	}
+
+
+	bool StructPool::owns(std::byte const* instance) const {
+		return this->locate(instance).has_value();
+	}
+
+
+
+	std::byte* StructPool::allocate_slot() {
+		auto const stride = this->struct_def->size;
+
+		if (this->free_slots.empty()) {
+			auto const slab_bytes = this->instances_per_slab * stride;
+			auto const data = static_cast<std::byte*>(::operator new(slab_bytes, std::align_val_t{this->slab_alignment}));
+
+			this->slabs.push_back(Slab {
+				data,
+				std::vector<std::uint64_t>((this->instances_per_slab + 63) / 64, 0),
+			});
+
+			auto const slab_idx = this->slabs.size() - 1;
+			auto const insert_it = std::upper_bound(
+				this->slabs_by_address.begin(), this->slabs_by_address.end(), data,
+				[this] (std::byte const* ptr, std::size_t idx) { return ptr < this->slabs[idx].data; }
+			);
+			this->slabs_by_address.insert(insert_it, slab_idx);
+
+			for (std::size_t slot_idx = this->instances_per_slab; slot_idx-- > 0;) {
+				this->free_slots.push_back(data + slot_idx * stride);
+			}
+		}
+
+		auto const instance = this->free_slots.back();
+		this->free_slots.pop_back();
+
+		auto const location = this->locate(instance);
+		this->slabs[location->slab_idx].live_bits[location->slot_idx / 64] |= std::uint64_t{1} << (location->slot_idx % 64);
+		this->live_count++;
+
+		return instance;
+	}
+
+
+	auto StructPool::locate(std::byte const* instance) const -> std::optional<SlotLocation> {
+		auto const it = std::upper_bound(
+			this->slabs_by_address.begin(), this->slabs_by_address.end(), instance,
+			[this] (std::byte const* ptr, std::size_t idx) { return ptr < this->slabs[idx].data; }
+		);
+
+		if (it == this->slabs_by_address.begin()) {
+			return std::nullopt;
+		}
+
+		auto const slab_idx = *std::prev(it);
+		auto const stride = this->struct_def->size;
+		auto const byte_offset = static_cast<std::size_t>(instance - this->slabs[slab_idx].data);
+
+		if (byte_offset >= this->instances_per_slab * stride || byte_offset % stride != 0) {
+			return std::nullopt;
+		}
+
+		return SlotLocation {slab_idx, byte_offset / stride};
+	}
+
+
+	void StructPool::destroy_live_instances() {
+		if (!this->struct_def->lifecycle.trivially_destructible) {
+			auto const destroy = this->struct_def->lifecycle.destroy;
+			this->for_each([destroy] (std::byte* instance) { destroy(instance); });
+		}
+
+		for (auto& slab : this->slabs) {
+			std::fill(slab.live_bits.begin(), slab.live_bits.end(), 0);
+		}
+
+		this->live_count = 0;
+	}
+
+
+
+	StructPool* StructPools::pool_for(StructId struct_id) {
+		auto pool_it = this->pools.find(struct_id);
+		if (pool_it != this->pools.end()) {
+			return &pool_it->second;
+		}
+
+		auto const struct_def = this->kernel->struct_def_for(struct_id);
+		if (!struct_def) {
+			return nullptr;
+		}
+
+		auto [new_it, _] = this->pools.emplace(struct_id, StructPool{struct_def});
+		return &new_it->second;
+	}
+
+
+	void StructPools::clear() {
+		for (auto& [_, pool] : this->pools) {
+			pool.clear();
+		}
+	}
+
+}
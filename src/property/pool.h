@@ -0,0 +1,102 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+namespace property {
+
+	// Slab allocator for instances of a single registered struct.
+	// Instances are laid out contiguously within slabs, and slabs are aligned to cache lines.
+	struct StructPool {
+		static constexpr std::size_t cache_line_size = 64;
+		static constexpr std::size_t default_slab_bytes = 16 * 1024;
+
+		StructPool(StructDef const* struct_def, std::size_t instances_per_slab = 0);
+		~StructPool();
+
+		StructPool(StructPool&&);
+		StructPool& operator=(StructPool&&);
+
+		StructPool(StructPool const&) = delete;
+		StructPool& operator=(StructPool const&) = delete;
+
+		// Returns a default constructed instance
+		std::byte* create();
+		// Returns a copy constructed instance, or nullptr if the struct isn't copyable
+		std::byte* create_copy(std::byte const* src);
+
+		void destroy(std::byte* instance);
+
+		// Resets an instance to the struct's default value.
+		// Trivially copyable structs are reset with a memcpy from the default value.
+		void reset_to_default(std::byte* instance) const;
+		void reset_all_to_default();
+
+		// Destroys all live instances, but keeps slabs around for reuse
+		void clear();
+		// Destroys all live instances and frees all slabs
+		void release();
+
+		template<class F>
+		void for_each(F&& func);
+
+		bool owns(std::byte const* instance) const;
+
+		auto size() const { return live_count; }
+		auto empty() const { return live_count == 0; }
+		auto capacity() const { return slabs.size() * instances_per_slab; }
+
+		StructDef const* struct_def;
+
+	private:
+		struct Slab {
+			std::byte* data;
+			std::vector<std::uint64_t> live_bits;
+		};
+
+		struct SlotLocation {
+			std::size_t slab_idx;
+			std::size_t slot_idx;
+		};
+
+		std::byte* allocate_slot();
+		auto locate(std::byte const* instance) const -> std::optional<SlotLocation>;
+		void destroy_live_instances();
+
+		std::size_t instances_per_slab;
+		std::size_t slab_alignment;
+		std::size_t live_count = 0;
+
+		std::vector<Slab> slabs;
+		// Indices into slabs, ordered by slab address. Used to find the slab owning an instance
+		std::vector<std::size_t> slabs_by_address;
+		std::vector<std::byte*> free_slots;
+	};
+
+
+	// A collection of StructPools keyed by StructId
+	struct StructPools {
+		Kernel const* kernel;
+		std::unordered_map<StructId, StructPool> pools;
+
+		StructPools(Kernel const& kernel) : kernel{&kernel} {}
+
+		// Returns nullptr if struct_id isn't registered
+		StructPool* pool_for(StructId struct_id);
+
+		template<class S>
+		S* create();
+
+		template<class S>
+		void destroy(S* instance);
+
+		void clear();
+	};
+
+} // property
+
+
+#include "property/pool.inl"
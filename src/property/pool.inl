@@ -0,0 +1,41 @@
+namespace property {
+
+	template<class F>
+	void StructPool::for_each(F&& func) {
+		auto const stride = this->struct_def->size;
+
+		for (auto& slab : this->slabs) {
+			for (std::size_t word_idx = 0; word_idx < slab.live_bits.size(); word_idx++) {
+				auto bits = slab.live_bits[word_idx];
+
+				while (bits != 0) {
+					auto const bit_idx = static_cast<std::size_t>(__builtin_ctzll(bits));
+					bits &= bits - 1;
+
+					auto const slot_idx = word_idx * 64 + bit_idx;
+					func(slab.data + slot_idx * stride);
+				}
+			}
+		}
+	}
+
+
+	template<class S>
+	S* StructPools::create() {
+		auto const pool = this->pool_for(this->kernel->get_struct_id<S>());
+		if (!pool) {
+			return nullptr;
+		}
+
+		return std::launder(reinterpret_cast<S*>(pool->create()));
+	}
+
+
+	template<class S>
+	void StructPools::destroy(S* instance) {
+		if (auto const pool = this->pool_for(this->kernel->get_struct_id<S>())) {
+			pool->destroy(reinterpret_cast<std::byte*>(instance));
+		}
+	}
+
+} // property
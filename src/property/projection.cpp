@@ -0,0 +1,196 @@
+#include "property/projection.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace property {
+
+	namespace {
+		struct LeafRange {
+			std::uint32_t begin;
+			std::uint32_t end;
+		};
+
+
+		void collect_leaf_ranges(Kernel const& kernel, StructDef const& struct_def, std::uint32_t base_offset, std::vector<LeafRange>& ranges) {
+			for (auto const& field_def : struct_def.fields) {
+				auto const offset = base_offset + static_cast<std::uint32_t>(field_def.field_info.offset);
+
+				if (auto struct_id = kernel.struct_id_from_type_id(field_def.field_info.type_id)) {
+					collect_leaf_ranges(kernel, *kernel.struct_def_for(*struct_id), offset, ranges);
+				} else {
+					ranges.push_back({offset, offset + static_cast<std::uint32_t>(field_def.field_info.size)});
+				}
+			}
+		}
+
+
+		std::uint32_t align_up(std::uint32_t offset, std::size_t alignment) {
+			auto const align = static_cast<std::uint32_t>(alignment);
+			return (offset + align - 1) / align * align;
+		}
+
+
+		// True if every byte of the struct is either a registered field or the alignment padding that the
+		// registered fields alone would produce, recursively through nested registered structs.
+		// Unregistered members larger than that padding leave a gap this rejects
+		bool is_fully_registered(Kernel const& kernel, StructDef const& struct_def) {
+			std::vector<FieldDef const*> fields_by_offset;
+			for (auto const& field_def : struct_def.fields) {
+				fields_by_offset.push_back(&field_def);
+			}
+
+			std::sort(fields_by_offset.begin(), fields_by_offset.end(), [] (auto&& lhs, auto&& rhs) {
+				return lhs->field_info.offset < rhs->field_info.offset;
+			});
+
+			std::uint32_t cursor = 0;
+			for (auto const field_def : fields_by_offset) {
+				auto const& field_info = field_def->field_info;
+				if (field_info.offset != align_up(cursor, field_info.alignment)) {
+					return false;
+				}
+
+				auto const struct_id = kernel.struct_id_from_type_id(field_info.type_id);
+				if (struct_id && !is_fully_registered(kernel, *kernel.struct_def_for(*struct_id))) {
+					return false;
+				}
+
+				cursor = static_cast<std::uint32_t>(field_info.offset + field_info.size);
+			}
+
+			return struct_def.size == align_up(cursor, struct_def.alignment);
+		}
+
+
+		void collect_matches(Kernel const& kernel, StructDef const& src_def, StructDef const& dst_def,
+			std::uint32_t src_base, std::uint32_t dst_base, std::string const& prefix, ProjectionPlan& plan)
+		{
+			for (auto const& dst_field : dst_def.fields) {
+				auto const path = prefix + dst_field.name;
+
+				auto const src_it = std::find_if(
+					src_def.fields.begin(), src_def.fields.end(),
+					[&dst_field] (auto&& src_field) { return src_field.name == dst_field.name; }
+				);
+
+				if (src_it == src_def.fields.end()) {
+					plan.unmatched_fields.push_back(path);
+					continue;
+				}
+
+				auto const& src_info = src_it->field_info;
+				auto const& dst_info = dst_field.field_info;
+				auto const src_offset = src_base + static_cast<std::uint32_t>(src_info.offset);
+				auto const dst_offset = dst_base + static_cast<std::uint32_t>(dst_info.offset);
+
+				auto const src_struct_id = kernel.struct_id_from_type_id(src_info.type_id);
+				auto const dst_struct_id = kernel.struct_id_from_type_id(dst_info.type_id);
+
+				if (src_struct_id && dst_struct_id) {
+					collect_matches(kernel, *kernel.struct_def_for(*src_struct_id), *kernel.struct_def_for(*dst_struct_id),
+						src_offset, dst_offset, path + "/", plan);
+
+				} else if (src_info.type_id != dst_info.type_id) {
+					plan.unmatched_fields.push_back(path);
+
+				} else if (dst_info.trivially_copyable) {
+					plan.copies.push_back({src_offset, dst_offset, static_cast<std::uint32_t>(dst_info.size)});
+
+				} else {
+					plan.assigns.push_back({src_offset, dst_offset, &dst_info});
+				}
+			}
+		}
+
+
+		// Merges ranges that are adjacent in both structs. If the destination is fully registered, ranges
+		// separated by equally sized gaps that are only padding in the destination are merged too
+		void merge_copies(std::vector<ProjectionPlan::CopyRange>& copies, std::vector<LeafRange> const& dst_leaves,
+			bool dst_fully_registered)
+		{
+			std::sort(copies.begin(), copies.end(), [] (auto&& lhs, auto&& rhs) {
+				return lhs.dst_offset < rhs.dst_offset;
+			});
+
+			auto const is_dst_padding = [&dst_leaves, dst_fully_registered] (std::uint32_t begin, std::uint32_t end) {
+				if (begin == end) {
+					return true;
+				}
+				return dst_fully_registered && std::none_of(dst_leaves.begin(), dst_leaves.end(), [begin, end] (LeafRange leaf) {
+					return leaf.begin < end && begin < leaf.end;
+				});
+			};
+
+			std::vector<ProjectionPlan::CopyRange> merged;
+			for (auto const& copy : copies) {
+				if (!merged.empty()) {
+					auto& prev = merged.back();
+					auto const prev_src_end = prev.src_offset + prev.size;
+					auto const prev_dst_end = prev.dst_offset + prev.size;
+
+					bool const same_gap = copy.src_offset >= prev_src_end
+						&& copy.src_offset - prev_src_end == copy.dst_offset - prev_dst_end;
+
+					if (same_gap && is_dst_padding(prev_dst_end, copy.dst_offset)) {
+						prev.size = copy.dst_offset + copy.size - prev.dst_offset;
+						continue;
+					}
+				}
+
+				merged.push_back(copy);
+			}
+
+			copies = std::move(merged);
+		}
+	}
+
+
+	auto make_projection(Kernel const& kernel, StructDef const& src, StructDef const& dst) -> ProjectionPlan {
+		ProjectionPlan plan {&src, &dst, {}, {}, {}, is_fully_registered(kernel, dst)};
+		collect_matches(kernel, src, dst, 0, 0, "", plan);
+
+		std::vector<LeafRange> dst_leaves;
+		collect_leaf_ranges(kernel, dst, 0, dst_leaves);
+		merge_copies(plan.copies, dst_leaves, plan.dst_fully_registered);
+
+		return plan;
+	}
+
+
+
+	void ProjectionPlan::apply(std::byte const* src, std::byte* dst) const {
+		for (auto const& copy : this->copies) {
+			std::memcpy(dst + copy.dst_offset, src + copy.src_offset, copy.size);
+		}
+
+		for (auto const& assign : this->assigns) {
+			assign.field_info->copy_assign(dst + assign.dst_offset, src + assign.src_offset);
+		}
+	}
+
+
+	void ProjectionPlan::apply(StructSpan src, StructMutSpan dst) const {
+		auto const count = std::min(src.count, dst.count);
+		auto const src_stride = this->src_struct_def->size;
+		auto const dst_stride = this->dst_struct_def->size;
+
+		// A single range covering both structs entirely is a plain array copy. Only a fully registered
+		// destination is known to have nothing but copied fields and padding
+		bool const whole_struct_copy = this->dst_fully_registered
+			&& this->assigns.empty() && this->copies.size() == 1
+			&& src_stride == dst_stride
+			&& this->copies[0].src_offset == 0 && this->copies[0].dst_offset == 0
+			&& this->copies[0].size == dst_stride;
+
+		if (whole_struct_copy) {
+			std::memcpy(dst.data, src.data, count * dst_stride);
+			return;
+		}
+
+		for (std::size_t idx = 0; idx < count; idx++) {
+			this->apply(src.data + idx * src_stride, dst.data + idx * dst_stride);
+		}
+	}
+
+}
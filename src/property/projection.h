@@ -0,0 +1,48 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace property {
+
+	// Precompiled copy between two registered structs, matching fields by name.
+	// Fields match if they have the same TypeId, or are both registered structs, in which case their
+	// fields are matched recursively. Trivially copyable matches become memcpy ranges, and ranges that are
+	// adjacent in both structs are merged. Ranges are only merged across padding when the destination is fully
+	// registered, since an unregistered member in a gap can't be told apart from padding otherwise.
+	// Other matches are copy assigned. Destination fields without a match are left untouched.
+	struct ProjectionPlan {
+		struct CopyRange {
+			std::uint32_t src_offset;
+			std::uint32_t dst_offset;
+			std::uint32_t size;
+		};
+
+		struct AssignField {
+			std::uint32_t src_offset;
+			std::uint32_t dst_offset;
+			FieldTypeInfo const* field_info;
+		};
+
+		StructDef const* src_struct_def;
+		StructDef const* dst_struct_def;
+
+		std::vector<CopyRange> copies;
+		std::vector<AssignField> assigns;
+
+		// '/' separated paths of destination fields with no match
+		std::vector<std::string> unmatched_fields;
+
+		// Every byte of the destination is a registered field or alignment padding between them
+		bool dst_fully_registered;
+
+		void apply(std::byte const* src, std::byte* dst) const;
+		void apply(StructSpan src, StructMutSpan dst) const;
+	};
+
+	auto make_projection(Kernel const& kernel, StructDef const& src, StructDef const& dst) -> ProjectionPlan;
+
+} // property
@@ -1,5 +1,7 @@
 #include "property/property.h"
 
+#include <mutex>
+
 #include <fmt/core.h>
 
 namespace property {
@@ -17,6 +19,19 @@ namespace property {
 	std::string FieldTypeInfo::format(std::byte const* field_ptr) const {
 		return get_base()->format(field_ptr);
 	}
+
+
+	bool FieldTypeInfo::copy_assign(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const {
+		return get_base()->copy_assign(dst_field_ptr, src_field_ptr);
+	}
+
+	bool FieldTypeInfo::copy_construct(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const {
+		return get_base()->copy_construct(dst_field_ptr, src_field_ptr);
+	}
+
+	void FieldTypeInfo::destroy(std::byte* field_ptr) const {
+		get_base()->destroy(field_ptr);
+	}
 	
 
 	internal::FieldTypeInfoErased const* FieldTypeInfo::get_base() const {
@@ -25,6 +40,47 @@ namespace property {
 
 
 
+	std::byte const* ListFieldInfo::get_element_ptr(std::byte const* field_ptr, std::size_t idx) const {
+		return this->element_ptr_fn(field_ptr, idx);
+	}
+
+
+	std::byte* ListFieldInfo::get_element_ptr(std::byte* field_ptr, std::size_t idx) const {
+		return const_cast<std::byte*>(this->element_ptr_fn(field_ptr, idx));
+	}
+
+
+	std::size_t ListFieldInfo::get_size(std::byte const* field_ptr) const {
+		return this->size_fn(field_ptr);
+	}
+
+
+	bool ListFieldInfo::resize(std::byte* field_ptr, std::size_t size) const {
+		if (!this->resize_fn) {
+			return false;
+		}
+
+		this->resize_fn(field_ptr, size);
+		return true;
+	}
+
+
+
+	auto EnumDef::find_variant(std::string_view display_name) const -> EnumVariantDef const* {
+		auto const it = std::lower_bound(
+			this->variants_by_name.begin(), this->variants_by_name.end(), display_name,
+			[this] (EnumVariantIdx idx, std::string_view name) { return this->variants[idx].display_name < name; }
+		);
+
+		if (it != this->variants_by_name.end() && this->variants[*it].display_name == display_name) {
+			return &this->variants[*it];
+		} else {
+			return nullptr;
+		}
+	}
+
+
+
 	auto Kernel::struct_def_for(StructId id) const -> StructDef const* {
 		auto it = std::find_if(
 			this->structs.begin(), this->structs.end(),
@@ -74,6 +130,106 @@ namespace property {
 
 
 
+	auto Kernel::fields_with_attribute(TypeId attribute_type_id) const -> std::span<AttributeIndexEntry const> {
+		auto index_it = this->attribute_index.find(attribute_type_id);
+		if (index_it != this->attribute_index.end()) {
+			return index_it->second;
+		} else {
+			return {};
+		}
+	}
+
+
+	auto Kernel::struct_contains_attribute(StructId id, TypeId attribute_type_id) const -> bool {
+		auto const struct_def = this->struct_def_for(id);
+		if (!struct_def) {
+			return false;
+		}
+
+		auto const& attribute_types = struct_def->contained_attribute_types;
+		return std::binary_search(attribute_types.begin(), attribute_types.end(), attribute_type_id);
+	}
+
+
+	static bool insert_sorted_unique(std::vector<TypeId>& type_ids, TypeId type_id) {
+		auto const insert_it = std::lower_bound(type_ids.begin(), type_ids.end(), type_id);
+		if (insert_it != type_ids.end() && *insert_it == type_id) {
+			return false;
+		}
+
+		type_ids.insert(insert_it, type_id);
+		return true;
+	}
+
+
+	// Adds the attribute to the struct's transitive summary, and to those of every struct containing it
+	static void add_contained_attribute(StructDef& struct_def, TypeId attribute_type_id) {
+		if (!insert_sorted_unique(struct_def.contained_attribute_types, attribute_type_id)) {
+			return;
+		}
+
+		for (auto const containing_struct : struct_def.containing_structs) {
+			add_contained_attribute(*containing_struct, attribute_type_id);
+		}
+	}
+
+
+	// Only called once per (field, attribute type)
+	void Kernel::index_attribute(StructDef& struct_def, FieldIdx field_idx, TypeId attribute_type_id) {
+		this->attribute_index[attribute_type_id].push_back(AttributeIndexEntry {struct_def.id, field_idx});
+
+		insert_sorted_unique(struct_def.attribute_types, attribute_type_id);
+		add_contained_attribute(struct_def, attribute_type_id);
+	}
+
+
+	// Links a field to its type's StructDef if that's registered. Fields added before their type is
+	// registered are linked by index_registered_struct instead
+	void Kernel::index_nested_struct(StructDef& struct_def, FieldIdx field_idx) {
+		auto const child_struct_id = this->struct_id_from_type_id(struct_def.fields[field_idx].field_info.type_id);
+		if (!child_struct_id) {
+			return;
+		}
+
+		auto const child_struct_def = const_cast<StructDef*>(this->struct_def_for(*child_struct_id));
+
+		auto& nested_structs = struct_def.nested_structs;
+		auto const insert_it = std::lower_bound(nested_structs.begin(), nested_structs.end(), field_idx, [] (auto&& nested, FieldIdx idx) {
+			return nested.field_idx < idx;
+		});
+		nested_structs.insert(insert_it, NestedStructField {field_idx, child_struct_def});
+
+		child_struct_def->containing_structs.push_back(&struct_def);
+		for (auto const attribute_type_id : child_struct_def->contained_attribute_types) {
+			add_contained_attribute(struct_def, attribute_type_id);
+		}
+	}
+
+
+	void Kernel::index_registered_struct(StructDef& struct_def, TypeId struct_type_id) {
+		for (auto& containing_struct : this->structs) {
+			if (&containing_struct == &struct_def) {
+				continue;
+			}
+
+			for (auto const& field_def : containing_struct.fields) {
+				if (field_def.field_info.type_id == struct_type_id) {
+					this->index_nested_struct(containing_struct, field_def.idx);
+				}
+			}
+		}
+	}
+
+
+
+	// Defined here rather than in hash.cpp, since registration calls it
+	void Kernel::invalidate_cached_plans() {
+		std::lock_guard lock {this->cached_plans_mutex};
+		this->hash_plans.clear();
+	}
+
+
+
 	static void inspect_impl(Kernel const& kernel, StructRef struct_ref, int indent);
 
 	static void inspect_impl(Kernel const& kernel, FieldRef field_ref, int indent) {
@@ -182,4 +338,127 @@ namespace property {
 		}
 	}
 
+
+
+	std::optional<FieldMutRef> resolve_field_path(Kernel const& kernel, StructMutRef struct_ref, std::string_view field_path) {
+		if (auto field_ref = resolve_field_path(kernel, static_cast<StructRef>(struct_ref), field_path)) {
+			return FieldMutRef {
+				field_ref->struct_id,
+				field_ref->field_def,
+				const_cast<std::byte*>(field_ref->field_ptr),
+			};
+		}
+
+		return std::nullopt;
+	}
+
+
+	std::optional<CompiledFieldPath> compile_field_path(Kernel const& kernel, StructDef const* struct_def, std::string_view field_path) {
+		auto const field_idxs = field_idx_path(kernel, struct_def, field_path);
+		if (!field_idxs) {
+			return std::nullopt;
+		}
+
+		std::size_t offset = 0;
+		FieldDef const* field_def = nullptr;
+
+		for (auto field_idx : *field_idxs) {
+			if (field_def) {
+				struct_def = kernel.struct_def_for(*kernel.struct_id_from_type_id(field_def->field_info.type_id));
+			}
+
+			field_def = &struct_def->fields[field_idx];
+			offset += field_def->field_info.offset;
+		}
+
+		return CompiledFieldPath {
+			struct_def->id,
+			field_def,
+			offset,
+		};
+	}
+
+
+	std::optional<std::vector<FieldIdx>> field_idx_path(Kernel const& kernel, StructDef const* struct_def, std::string_view field_path) {
+		if (field_path.empty()) {
+			return std::nullopt;
+		}
+
+		std::vector<FieldIdx> field_idxs;
+
+		while (true) {
+			auto const [path_segment, tail] = split(field_path, '/');
+			field_path = tail;
+
+			auto const field_it = std::find_if(
+				struct_def->fields.begin(), struct_def->fields.end(),
+				[path_segment=path_segment] (auto&& field_def) {
+					return field_def.name == path_segment;
+				}
+			);
+
+			if (field_it == struct_def->fields.end()) {
+				return std::nullopt;
+			}
+
+			field_idxs.push_back(field_it->idx);
+
+			if (field_path.empty()) {
+				return field_idxs;
+			}
+
+			if (auto struct_id = kernel.struct_id_from_type_id(field_it->field_info.type_id)) {
+				struct_def = kernel.struct_def_for(*struct_id);
+			} else {
+				return std::nullopt;
+			}
+		}
+	}
+
+
+	std::optional<FieldRef> resolve_field_idx_path(Kernel const& kernel, StructRef struct_ref, std::span<FieldIdx const> field_path) {
+		if (field_path.empty()) {
+			return std::nullopt;
+		}
+
+		auto [struct_def, field_ptr] = struct_ref;
+
+		for (std::size_t segment = 0;; segment++) {
+			auto const field_idx = field_path[segment];
+			if (!struct_def || field_idx >= struct_def->fields.size()) {
+				return std::nullopt;
+			}
+
+			auto const& field_def = struct_def->fields[field_idx];
+			field_ptr += field_def.field_info.offset;
+
+			if (segment+1 == field_path.size()) {
+				return FieldRef {
+					struct_def->id,
+					&field_def,
+					field_ptr,
+				};
+			}
+
+			if (auto struct_id = kernel.struct_id_from_type_id(field_def.field_info.type_id)) {
+				struct_def = kernel.struct_def_for(*struct_id);
+			} else {
+				return std::nullopt;
+			}
+		}
+	}
+
+
+	std::optional<FieldMutRef> resolve_field_idx_path(Kernel const& kernel, StructMutRef struct_ref, std::span<FieldIdx const> field_path) {
+		if (auto field_ref = resolve_field_idx_path(kernel, static_cast<StructRef>(struct_ref), field_path)) {
+			return FieldMutRef {
+				field_ref->struct_id,
+				field_ref->field_def,
+				const_cast<std::byte*>(field_ref->field_ptr),
+			};
+		}
+
+		return std::nullopt;
+	}
+
 }
\ No newline at end of file
@@ -6,13 +6,17 @@
 
 #include <string>
 #include <cstdint>
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <unordered_map>
 #include <vector>
 #include <optional>
 #include <string_view>
+#include <span>
 #include <new>
+#include <memory>
+#include <shared_mutex>
 #include <fmt/format.h>
 
 
@@ -37,8 +41,31 @@ namespace property {
 		struct FieldTypeInfoErased {
 			virtual std::byte const* adjust_struct_ptr(std::byte const* struct_ptr) const = 0;
 			virtual std::string format(std::byte const* struct_ptr) const = 0;
+			virtual bool copy_assign(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const = 0;
+			virtual bool copy_construct(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const = 0;
+			virtual void destroy(std::byte* field_ptr) const = 0;
 		};
 
+		template<class F>
+		bool copy_assign_field(std::byte* dst_field_ptr, std::byte const* src_field_ptr) {
+			if constexpr (std::is_copy_assignable_v<F>) {
+				*std::launder(reinterpret_cast<F*>(dst_field_ptr)) = *std::launder(reinterpret_cast<F const*>(src_field_ptr));
+				return true;
+			} else {
+				return false;
+			}
+		}
+
+		template<class F>
+		bool copy_construct_field(std::byte* dst_field_ptr, std::byte const* src_field_ptr) {
+			if constexpr (std::is_copy_constructible_v<F>) {
+				new (dst_field_ptr) F(*std::launder(reinterpret_cast<F const*>(src_field_ptr)));
+				return true;
+			} else {
+				return false;
+			}
+		}
+
 		template<class S, class F>
 		struct FieldTypeInfoErasedImpl final : FieldTypeInfoErased {
 			F S::* field_offset;
@@ -56,6 +83,18 @@ namespace property {
 				auto const& field_data = *std::launder(field_ptr);
 				return fmt::format("{}", field_data);
 			}
+
+			bool copy_assign(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const final {
+				return copy_assign_field<F>(dst_field_ptr, src_field_ptr);
+			}
+
+			bool copy_construct(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const final {
+				return copy_construct_field<F>(dst_field_ptr, src_field_ptr);
+			}
+
+			void destroy(std::byte* field_ptr) const final {
+				std::destroy_at(std::launder(reinterpret_cast<F*>(field_ptr)));
+			}
 		};
 
 		template<class S, ListLikeProperty F>
@@ -75,6 +114,18 @@ namespace property {
 				// auto const& field_data = *std::launder(field_ptr);
 				return fmt::format("<some list>");
 			}
+
+			bool copy_assign(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const final {
+				return copy_assign_field<F>(dst_field_ptr, src_field_ptr);
+			}
+
+			bool copy_construct(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const final {
+				return copy_construct_field<F>(dst_field_ptr, src_field_ptr);
+			}
+
+			void destroy(std::byte* field_ptr) const final {
+				std::destroy_at(std::launder(reinterpret_cast<F*>(field_ptr)));
+			}
 		};
 	}
 
@@ -83,6 +134,10 @@ namespace property {
 		template<StandardLayout S, class F>
 		FieldTypeInfo(F S::* field)
 			: type_id {property::type_id<F>()}
+			, size {sizeof(F)}
+			, alignment {alignof(F)}
+			, trivially_copyable {std::is_trivially_copyable_v<F>}
+			, copy_assignable {std::is_copy_assignable_v<F>}
 		{
 			static_assert(sizeof(internal::FieldTypeInfoErasedImpl<S, F>) <= sizeof(this->offset_storage));
 			static_assert(alignof(internal::FieldTypeInfoErasedImpl<S, F>) <= alignof(internal::FieldTypeInfoErased));
@@ -95,6 +150,13 @@ namespace property {
 		// TODO: its kinda weird that this takes field_ptr but nothing else does?
 		std::string format(std::byte const* field_ptr) const;
 
+		// Returns false if the field type isn't copy assignable
+		bool copy_assign(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const;
+		// Copy constructs a field into uninitialised storage of the field's size and alignment.
+		// Returns false if the field type isn't copy constructible
+		bool copy_construct(std::byte* dst_field_ptr, std::byte const* src_field_ptr) const;
+		void destroy(std::byte* field_ptr) const;
+
 		template<class F>
 		bool matches_type() const;
 
@@ -106,17 +168,35 @@ namespace property {
 
 	public:
 		TypeId type_id;
+
+		// Layout of the field within its parent struct. offset is filled in at registration
+		std::size_t offset = 0;
+		std::size_t size;
+		std::size_t alignment;
+		bool trivially_copyable;
+		bool copy_assignable;
 	};
 
 
 
 	struct ListFieldInfo {
 		TypeId element_type_id;
+		std::size_t element_size;
+		bool element_trivially_copyable;
+		// Whether elements are stored contiguously, so that get_element_ptr(field_ptr, 0) points to all of them
+		bool contiguous;
 
 		std::byte const* get_element_ptr(std::byte const* field_ptr, std::size_t) const;
+		std::byte* get_element_ptr(std::byte* field_ptr, std::size_t) const;
 		std::size_t get_size(std::byte const* field_ptr) const;
 
-		// TODO: how to modify?
+		// Returns false if the list type can't be resized
+		bool resize(std::byte* field_ptr, std::size_t) const;
+
+		std::byte const* (*element_ptr_fn)(std::byte const* field_ptr, std::size_t);
+		std::size_t (*size_fn)(std::byte const* field_ptr);
+		// Null if the list type has no resize member
+		void (*resize_fn)(std::byte* field_ptr, std::size_t);
 	};
 
 
@@ -129,15 +209,53 @@ namespace property {
 		std::string description;
 		AttributeList attributes;
 		FieldTypeInfo field_info;
-		// TODO: std::optional<ListFieldInfo> list_info;
+		std::optional<ListFieldInfo> list_info;
+	};
+
+	// Type erased construction/destruction of a registered struct. copy_construct, move_construct
+	// and copy_assign are null if the struct doesn't support them
+	struct StructLifecycle {
+		void (*default_construct)(std::byte* dst);
+		void (*copy_construct)(std::byte* dst, std::byte const* src);
+		void (*move_construct)(std::byte* dst, std::byte* src);
+		void (*copy_assign)(std::byte* dst, std::byte const* src);
+		void (*destroy)(std::byte* ptr);
+
+		bool trivially_copyable;
+		bool trivially_destructible;
+	};
+
+	struct StructDef;
+
+	// A field whose type is a registered struct
+	struct NestedStructField {
+		FieldIdx field_idx;
+		StructDef const* struct_def;
 	};
 
 	struct StructDef {
 		StructId id;
 		std::string name;
 		std::size_t size;
+		std::size_t alignment;
 
 		std::vector<FieldDef> fields;
+
+		// Sorted, unique TypeIds of every attribute attached to this struct's own fields
+		std::vector<TypeId> attribute_types;
+		// As attribute_types, but also including the attributes of every struct nested within this one.
+		// Kept up to date as fields, attributes and structs are registered
+		std::vector<TypeId> contained_attribute_types;
+
+		// Sorted by FieldIdx
+		std::vector<NestedStructField> nested_structs;
+		// Structs with a field of this struct's type
+		std::vector<StructDef*> containing_structs;
+
+		StructLifecycle lifecycle;
+
+		// A value initialised instance, used as the source for resetting instances to default
+		std::shared_ptr<std::byte const> default_value;
 	};
 
 	struct EnumVariantDef {
@@ -150,6 +268,19 @@ namespace property {
 		std::string name;
 
 		std::vector<EnumVariantDef> variants;
+
+		// Indices into variants, sorted by display_name
+		std::vector<EnumVariantIdx> variants_by_name;
+
+		auto find_variant(std::string_view display_name) const -> EnumVariantDef const*;
+	};
+
+	struct KernelMemoryReport;
+	struct HashPlan;
+
+	struct AttributeIndexEntry {
+		StructId struct_id;
+		FieldIdx field_idx;
 	};
 
 	
@@ -159,6 +290,9 @@ namespace property {
 		std::unordered_map<TypeId, StructId> type_id_to_struct;
 		std::unordered_map<TypeId, StructId> type_id_to_enum;
 
+		// Every field carrying a given attribute type, across all registered structs
+		std::unordered_map<TypeId, std::vector<AttributeIndexEntry>> attribute_index;
+
 		mutable std::atomic<StructId> registered_type_id_alloc;
 
 		template<class S>
@@ -176,6 +310,32 @@ namespace property {
 		auto enum_def_for() const -> EnumDef const*;
 		auto enum_def_for(EnumId) const -> EnumDef const*;
 		auto enum_id_from_type_id(TypeId) const -> std::optional<EnumId>;
+
+
+		template<class A>
+		auto fields_with_attribute() const -> std::span<AttributeIndexEntry const>;
+		auto fields_with_attribute(TypeId) const -> std::span<AttributeIndexEntry const>;
+
+		// Whether any field of the struct, or of structs nested within it, carries the attribute
+		template<class A>
+		auto struct_contains_attribute(StructId) const -> bool;
+		auto struct_contains_attribute(StructId, TypeId) const -> bool;
+
+		void index_attribute(StructDef&, FieldIdx, TypeId);
+		void index_nested_struct(StructDef&, FieldIdx);
+		void index_registered_struct(StructDef&, TypeId);
+
+		// Defined in property/memory_report.h
+		auto estimate_memory_usage() const -> KernelMemoryReport;
+
+		// Defined in property/hash.h. Built on first use, and cached until a struct or field is registered
+		auto hash_plan_for(StructDef const&) const -> std::shared_ptr<HashPlan const>;
+		// Called by registration
+		void invalidate_cached_plans();
+
+		// Guarded by cached_plans_mutex
+		mutable std::unordered_map<StructId, std::shared_ptr<HashPlan const>> hash_plans;
+		mutable std::shared_mutex cached_plans_mutex;
 	};
 
 
@@ -206,14 +366,92 @@ namespace property {
 	};
 
 
+	struct FieldMutRef {
+		StructId struct_id;
+		FieldDef const* field_def;
+		std::byte* field_ptr;
+
+
+		template<class F>
+		F* try_get() const;
+
+		template<class F>
+		bool try_write(F value) const;
+
+		operator FieldRef() const { return FieldRef{struct_id, field_def, field_ptr}; }
+	};
+
+	struct StructMutRef {
+		StructDef const* struct_def;
+		std::byte* struct_ptr;
+
+		operator StructRef() const { return StructRef{struct_def, struct_ptr}; }
+	};
+
+
+	// Contiguous arrays of instances of a registered struct
+	struct StructSpan {
+		StructDef const* struct_def;
+		std::byte const* data;
+		std::size_t count;
+
+		StructRef operator[](std::size_t idx) const { return StructRef{struct_def, data + idx * struct_def->size}; }
+	};
+
+	struct StructMutSpan {
+		StructDef const* struct_def;
+		std::byte* data;
+		std::size_t count;
+
+		StructMutRef operator[](std::size_t idx) const { return StructMutRef{struct_def, data + idx * struct_def->size}; }
+
+		operator StructSpan() const { return StructSpan{struct_def, data, count}; }
+	};
+
+
+	// A field path resolved once to an offset from the root struct, for fast repeated access
+	struct CompiledFieldPath {
+		// The struct directly containing the field
+		StructId struct_id;
+		FieldDef const* field_def;
+		std::size_t offset;
+
+		FieldRef resolve(std::byte const* struct_ptr) const { return FieldRef{struct_id, field_def, struct_ptr + offset}; }
+		FieldMutRef resolve(std::byte* struct_ptr) const { return FieldMutRef{struct_id, field_def, struct_ptr + offset}; }
+	};
+
+
 	template<class S>
 	auto type_erase_struct(Kernel const& kernel, S const* s) -> StructRef;
 
+	template<class S>
+	auto type_erase_struct_mut(Kernel const& kernel, S* s) -> StructMutRef;
+
+	template<class S>
+	auto type_erase_span(Kernel const& kernel, std::span<S const> s) -> StructSpan;
+
+	template<class S>
+	auto type_erase_span_mut(Kernel const& kernel, std::span<S> s) -> StructMutSpan;
+
 
 	void inspect(Kernel const& kernel, StructRef struct_ref);
 	void inspect(Kernel const& kernel, FieldRef field_ref);
 
 	std::optional<FieldRef> resolve_field_path(Kernel const& kernel, StructRef struct_ref, std::string_view field_path);
+	std::optional<FieldMutRef> resolve_field_path(Kernel const& kernel, StructMutRef struct_ref, std::string_view field_path);
+
+	std::optional<CompiledFieldPath> compile_field_path(Kernel const& kernel, StructDef const* struct_def, std::string_view field_path);
+
+	// Converts a '/' separated field path into the FieldIdx of each segment
+	std::optional<std::vector<FieldIdx>> field_idx_path(Kernel const& kernel, StructDef const* struct_def, std::string_view field_path);
+
+	std::optional<FieldRef> resolve_field_idx_path(Kernel const& kernel, StructRef struct_ref, std::span<FieldIdx const> field_path);
+	std::optional<FieldMutRef> resolve_field_idx_path(Kernel const& kernel, StructMutRef struct_ref, std::span<FieldIdx const> field_path);
+
+	// Calls func with each FieldRef carrying attribute A, in field order, recursing into nested structs.
+	// Structs that don't contain the attribute anywhere are skipped without visiting their fields
+	template<class A, class F>
+	void for_each_field_with_attribute(Kernel const& kernel, StructRef struct_ref, F&& func);
 
 } // property
 
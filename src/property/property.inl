@@ -56,6 +56,19 @@ namespace property {
 	}
 
 
+	template<class A>
+	auto Kernel::fields_with_attribute() const -> std::span<AttributeIndexEntry const> {
+		return this->fields_with_attribute(property::type_id<A>());
+	}
+
+
+	template<class A>
+	auto Kernel::struct_contains_attribute(StructId id) const -> bool {
+		return this->struct_contains_attribute(id, property::type_id<A>());
+	}
+
+
+
 	template<class F>
 	F const* FieldRef::try_read() const {
 		if (!this->field_def->field_info.matches_type<F>()) {
@@ -67,6 +80,28 @@ namespace property {
 
 
 
+	template<class F>
+	F* FieldMutRef::try_get() const {
+		if (!this->field_def->field_info.matches_type<F>()) {
+			return nullptr;
+		}
+
+		return std::launder(reinterpret_cast<F*>(this->field_ptr));
+	}
+
+
+	template<class F>
+	bool FieldMutRef::try_write(F value) const {
+		if (auto field = this->try_get<F>()) {
+			*field = std::move(value);
+			return true;
+		}
+
+		return false;
+	}
+
+
+
 	template<class A>
 	bool FieldRef::has_attribute() const { return this->field_def->attributes.has_attribute<A>(); }
 
@@ -83,4 +118,75 @@ namespace property {
 		};
 	}
 
+
+	template<class S>
+	auto type_erase_struct_mut(Kernel const& kernel, S* s) -> StructMutRef {
+		return StructMutRef {
+			kernel.struct_def_for<S>(),
+			reinterpret_cast<std::byte*>(s),
+		};
+	}
+
+
+	template<class S>
+	auto type_erase_span(Kernel const& kernel, std::span<S const> s) -> StructSpan {
+		return StructSpan {
+			kernel.struct_def_for<S>(),
+			reinterpret_cast<std::byte const*>(s.data()),
+			s.size(),
+		};
+	}
+
+
+	template<class S>
+	auto type_erase_span_mut(Kernel const& kernel, std::span<S> s) -> StructMutSpan {
+		return StructMutSpan {
+			kernel.struct_def_for<S>(),
+			reinterpret_cast<std::byte*>(s.data()),
+			s.size(),
+		};
+	}
+
+
+
+	template<class A, class F>
+	void for_each_field_with_attribute(Kernel const& kernel, StructRef struct_ref, F&& func) {
+		auto const attribute_type_id = property::type_id<A>();
+		auto const [struct_def, struct_ptr] = struct_ref;
+
+		auto const contains = [attribute_type_id] (std::vector<TypeId> const& attribute_types) {
+			return std::binary_search(attribute_types.begin(), attribute_types.end(), attribute_type_id);
+		};
+
+		if (!contains(struct_def->contained_attribute_types)) {
+			return;
+		}
+
+		auto const visit_nested = [&] (NestedStructField const& nested) {
+			if (contains(nested.struct_def->contained_attribute_types)) {
+				auto const field_ptr = struct_ptr + struct_def->fields[nested.field_idx].field_info.offset;
+				for_each_field_with_attribute<A>(kernel, StructRef{nested.struct_def, field_ptr}, func);
+			}
+		};
+
+		// Only the nested structs need visiting if none of this struct's own fields carry the attribute
+		if (!contains(struct_def->attribute_types)) {
+			for (auto const& nested : struct_def->nested_structs) {
+				visit_nested(nested);
+			}
+			return;
+		}
+
+		auto nested_it = struct_def->nested_structs.begin();
+		for (auto const& field_def : struct_def->fields) {
+			if (field_def.attributes.has_attribute<A>()) {
+				func(FieldRef{struct_def->id, &field_def, struct_ptr + field_def.field_info.offset});
+			}
+
+			if (nested_it != struct_def->nested_structs.end() && nested_it->field_idx == field_def.idx) {
+				visit_nested(*nested_it++);
+			}
+		}
+	}
+
 } // property
\ No newline at end of file
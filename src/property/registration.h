@@ -1,10 +1,13 @@
 #include "property/property.h"
 
+#include <ranges>
+
 namespace property {
 
 	template<class Property>
 	struct FieldBuilder {
 		struct Kernel* kernel;
+		StructDef* struct_def;
 		FieldDef* field_def;
 
 		template<AttributeCompatible<Property> A>
@@ -34,7 +37,7 @@ namespace property {
 	};
 
 
-	template<StandardLayout S>
+	template<RegistrableStruct S>
 	auto register_struct(Kernel&, std::string name) -> StructBuilder<S>;
 
 	template<Enum E>
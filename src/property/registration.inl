@@ -1,5 +1,82 @@
 namespace property {
-	template<StandardLayout S>
+	namespace internal {
+		template<class S>
+		auto make_struct_lifecycle() -> StructLifecycle {
+			StructLifecycle lifecycle {
+				[] (std::byte* dst) { new (dst) S(); },
+				nullptr,
+				nullptr,
+				nullptr,
+				[] (std::byte* ptr) { std::launder(reinterpret_cast<S*>(ptr))->~S(); },
+
+				std::is_trivially_copyable_v<S>,
+				std::is_trivially_destructible_v<S>,
+			};
+
+			if constexpr (std::is_copy_constructible_v<S>) {
+				lifecycle.copy_construct = [] (std::byte* dst, std::byte const* src) {
+					new (dst) S(*std::launder(reinterpret_cast<S const*>(src)));
+				};
+			}
+
+			if constexpr (std::is_move_constructible_v<S>) {
+				lifecycle.move_construct = [] (std::byte* dst, std::byte* src) {
+					new (dst) S(std::move(*std::launder(reinterpret_cast<S*>(src))));
+				};
+			}
+
+			if constexpr (std::is_copy_assignable_v<S>) {
+				lifecycle.copy_assign = [] (std::byte* dst, std::byte const* src) {
+					*std::launder(reinterpret_cast<S*>(dst)) = *std::launder(reinterpret_cast<S const*>(src));
+				};
+			}
+
+			return lifecycle;
+		}
+
+		template<class S>
+		auto make_default_value() -> std::shared_ptr<std::byte const> {
+			auto value = std::make_shared<S>();
+			auto const value_ptr = reinterpret_cast<std::byte const*>(value.get());
+			return std::shared_ptr<std::byte const>(std::move(value), value_ptr);
+		}
+
+		template<ListLikeProperty L>
+		auto make_list_field_info() -> ListFieldInfo {
+			using Element = std::ranges::range_value_t<L>;
+
+			ListFieldInfo list_info {
+				property::type_id<Element>(),
+				sizeof(Element),
+				std::is_trivially_copyable_v<Element>,
+				std::ranges::contiguous_range<L>,
+
+				[] (std::byte const* field_ptr, std::size_t idx) {
+					auto const& list = *std::launder(reinterpret_cast<L const*>(field_ptr));
+					auto const& element = *std::next(std::ranges::begin(list), idx);
+					return reinterpret_cast<std::byte const*>(&element);
+				},
+
+				[] (std::byte const* field_ptr) {
+					auto const& list = *std::launder(reinterpret_cast<L const*>(field_ptr));
+					return static_cast<std::size_t>(std::ranges::size(list));
+				},
+
+				nullptr,
+			};
+
+			if constexpr (requires (L& list) { list.resize(std::size_t{}); }) {
+				list_info.resize_fn = [] (std::byte* field_ptr, std::size_t size) {
+					std::launder(reinterpret_cast<L*>(field_ptr))->resize(size);
+				};
+			}
+
+			return list_info;
+		}
+	}
+
+
+	template<RegistrableStruct S>
 	auto register_struct(Kernel& kernel, std::string name) -> StructBuilder<S> {
 		auto const struct_id = kernel.get_struct_id<S>();
 
@@ -7,10 +84,20 @@ namespace property {
 			struct_id,
 			std::move(name),
 			sizeof(S),
-			{}
+			alignof(S),
+			{},
+			{},
+			{},
+			{},
+			{},
+
+			internal::make_struct_lifecycle<S>(),
+			internal::make_default_value<S>(),
 		});
 
 		kernel.type_id_to_struct.insert({type_id<S>(), struct_id});
+		kernel.index_registered_struct(kernel.structs.back(), type_id<S>());
+		kernel.invalidate_cached_plans();
 
 		return StructBuilder<S> {
 			&kernel,
@@ -26,7 +113,8 @@ namespace property {
 		kernel.enums.push_back(EnumDef {
 			enum_id,
 			std::move(name),
-			{}
+			{},
+			{},
 		});
 
 		kernel.type_id_to_enum.insert({type_id<E>(), enum_id});
@@ -53,10 +141,19 @@ namespace property {
 
 			{},
 			FieldTypeInfo { field },
+			std::nullopt,
 		});
 
+		auto& field_info = this->struct_def->fields.back().field_info;
+		auto const default_ptr = this->struct_def->default_value.get();
+		field_info.offset = field_info.adjust_struct_ptr(default_ptr) - default_ptr;
+
+		this->kernel->index_nested_struct(*this->struct_def, field_idx);
+		this->kernel->invalidate_cached_plans();
+
 		return FieldBuilder<Property> {
 			this->kernel,
+			this->struct_def,
 			&this->struct_def->fields.back(),
 		};
 	}
@@ -76,10 +173,18 @@ namespace property {
 
 			{},
 			FieldTypeInfo { field },
+			internal::make_list_field_info<Property>(),
 		});
 
+		auto& field_def = this->struct_def->fields.back();
+		auto const default_ptr = this->struct_def->default_value.get();
+		field_def.field_info.offset = field_def.field_info.adjust_struct_ptr(default_ptr) - default_ptr;
+
+		this->kernel->invalidate_cached_plans();
+
 		return FieldBuilder<Property> {
 			this->kernel,
+			this->struct_def,
 			&this->struct_def->fields.back(),
 		};
 	}
@@ -88,7 +193,12 @@ namespace property {
 	template<class Property>
 	template<AttributeCompatible<Property> A>
 	void FieldBuilder<Property>::add_attribute(A attribute) {
+		bool const first_of_type = !this->field_def->attributes.template has_attribute<A>();
 		this->field_def->attributes.add_attribute(std::move(attribute));
+
+		if (first_of_type) {
+			this->kernel->index_attribute(*this->struct_def, this->field_def->idx, property::type_id<A>());
+		}
 	}
 
 
@@ -96,9 +206,19 @@ namespace property {
 	void EnumBuilder<E>::add_variant(E value, std::string display_name) {
 		// TODO: static_assert value can be stored in an int
 
+		EnumVariantIdx const variant_idx = this->enum_def->variants.size();
+
 		this->enum_def->variants.push_back(EnumVariantDef {
 			std::move(display_name),
 			static_cast<int>(value),
 		});
+
+		auto& variants_by_name = this->enum_def->variants_by_name;
+		auto const& variants = this->enum_def->variants;
+		auto const insert_it = std::lower_bound(
+			variants_by_name.begin(), variants_by_name.end(), variants.back().display_name,
+			[&variants] (EnumVariantIdx idx, std::string const& name) { return variants[idx].display_name < name; }
+		);
+		variants_by_name.insert(insert_it, variant_idx);
 	}
 }
\ No newline at end of file
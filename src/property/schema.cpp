@@ -0,0 +1,342 @@
+#include "property/schema.h"
+#include "property/hash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <fmt/format.h>
+
+namespace property {
+
+	namespace {
+		std::string type_name_for_type_id(Kernel const& kernel, TypeId type_id) {
+			if (auto struct_id = kernel.struct_id_from_type_id(type_id)) {
+				return kernel.struct_def_for(*struct_id)->name;
+			}
+
+			if (auto enum_id = kernel.enum_id_from_type_id(type_id)) {
+				return kernel.enum_def_for(*enum_id)->name;
+			}
+
+			return format_debug(type_id);
+		}
+
+
+		void collect_leaf_fields(Kernel const& kernel, StructDef const& struct_def, std::string const& prefix,
+			std::uint32_t base_offset, std::vector<StoredFieldSchema>& fields)
+		{
+			for (auto const& field_def : struct_def.fields) {
+				auto const& field_info = field_def.field_info;
+				auto const offset = base_offset + static_cast<std::uint32_t>(field_info.offset);
+				auto path = prefix + field_def.name;
+
+				if (auto struct_id = kernel.struct_id_from_type_id(field_info.type_id)) {
+					collect_leaf_fields(kernel, *kernel.struct_def_for(*struct_id), path + "/", offset, fields);
+					continue;
+				}
+
+				fields.push_back(StoredFieldSchema {
+					std::move(path),
+					type_name(kernel, field_def),
+					offset,
+					static_cast<std::uint32_t>(field_info.size),
+					field_info.trivially_copyable,
+				});
+			}
+		}
+
+
+		SchemaFingerprint fingerprint_fields(std::uint32_t struct_size, std::vector<StoredFieldSchema> const& fields) {
+			auto const hash_string = [] (std::string const& string, std::uint64_t seed) {
+				return internal::hash_bytes(reinterpret_cast<std::byte const*>(string.data()), string.size(), seed);
+			};
+
+			auto fingerprint = internal::hash_bytes(reinterpret_cast<std::byte const*>(&struct_size), sizeof struct_size, 0);
+
+			for (auto const& field : fields) {
+				std::uint32_t const layout[] {field.offset, field.size};
+
+				fingerprint = hash_string(field.path, fingerprint);
+				fingerprint = hash_string(field.type_name, fingerprint);
+				fingerprint = internal::hash_bytes(reinterpret_cast<std::byte const*>(layout), sizeof layout, fingerprint);
+			}
+
+			return fingerprint;
+		}
+
+
+		void merge_ranges(std::vector<MigrationPlan::CopyRange>& ranges) {
+			std::sort(ranges.begin(), ranges.end(), [] (auto&& lhs, auto&& rhs) {
+				return lhs.dst_offset < rhs.dst_offset;
+			});
+
+			std::vector<MigrationPlan::CopyRange> merged;
+			for (auto const& range : ranges) {
+				if (!merged.empty()) {
+					auto& prev = merged.back();
+					if (prev.src_offset + prev.size == range.src_offset && prev.dst_offset + prev.size == range.dst_offset) {
+						prev.size += range.size;
+						continue;
+					}
+				}
+
+				merged.push_back(range);
+			}
+
+			ranges = std::move(merged);
+		}
+
+
+		struct SchemaWriter {
+			std::vector<std::byte>& buffer;
+
+			template<class T>
+			void write(T value) {
+				auto const offset = this->buffer.size();
+				this->buffer.resize(offset + sizeof value);
+				std::memcpy(this->buffer.data() + offset, &value, sizeof value);
+			}
+
+			void write_string(std::string const& string) {
+				this->write(static_cast<std::uint32_t>(string.size()));
+				auto const data = reinterpret_cast<std::byte const*>(string.data());
+				this->buffer.insert(this->buffer.end(), data, data + string.size());
+			}
+		};
+
+
+		// The inverse of SchemaWriter. Every read fails once any read has run past the end of data
+		struct SchemaReader {
+			std::span<std::byte const> data;
+
+			template<class T>
+			bool read(T& value) {
+				if (this->data.size() < sizeof value) {
+					return false;
+				}
+
+				std::memcpy(&value, this->data.data(), sizeof value);
+				this->data = this->data.subspan(sizeof value);
+				return true;
+			}
+
+			bool read_string(std::string& string) {
+				std::uint32_t size;
+				if (!this->read(size) || this->data.size() < size) {
+					return false;
+				}
+
+				string.assign(reinterpret_cast<char const*>(this->data.data()), size);
+				this->data = this->data.subspan(size);
+				return true;
+			}
+		};
+	}
+
+
+	std::string type_name(Kernel const& kernel, FieldDef const& field_def) {
+		if (field_def.list_info) {
+			return fmt::format("List<{}>", type_name_for_type_id(kernel, field_def.list_info->element_type_id));
+		}
+
+		return type_name_for_type_id(kernel, field_def.field_info.type_id);
+	}
+
+
+	auto capture_schema(Kernel const& kernel, StructDef const& struct_def) -> StoredSchema {
+		StoredSchema schema {
+			struct_def.name,
+			static_cast<std::uint32_t>(struct_def.size),
+			{},
+			0,
+		};
+
+		collect_leaf_fields(kernel, struct_def, "", 0, schema.fields);
+		schema.fingerprint = fingerprint_fields(schema.size, schema.fields);
+		return schema;
+	}
+
+
+	auto schema_fingerprint(Kernel const& kernel, StructDef const& struct_def) -> SchemaFingerprint {
+		return capture_schema(kernel, struct_def).fingerprint;
+	}
+
+
+	void write_schema(StoredSchema const& schema, std::vector<std::byte>& buffer) {
+		SchemaWriter writer {buffer};
+
+		writer.write_string(schema.name);
+		writer.write(schema.size);
+		writer.write(schema.fingerprint);
+		writer.write(static_cast<std::uint32_t>(schema.fields.size()));
+
+		for (auto const& field : schema.fields) {
+			writer.write_string(field.path);
+			writer.write_string(field.type_name);
+			writer.write(field.offset);
+			writer.write(field.size);
+			writer.write(static_cast<std::uint8_t>(field.trivially_copyable));
+		}
+	}
+
+
+	auto read_schema(std::span<std::byte const> data) -> std::optional<StoredSchema> {
+		SchemaReader reader {data};
+		StoredSchema schema;
+		std::uint32_t field_count;
+
+		if (!reader.read_string(schema.name) || !reader.read(schema.size) || !reader.read(schema.fingerprint)
+			|| !reader.read(field_count))
+		{
+			return std::nullopt;
+		}
+
+		for (std::uint32_t field_idx = 0; field_idx < field_count; field_idx++) {
+			StoredFieldSchema field;
+			std::uint8_t trivially_copyable;
+
+			if (!reader.read_string(field.path) || !reader.read_string(field.type_name) || !reader.read(field.offset)
+				|| !reader.read(field.size) || !reader.read(trivially_copyable))
+			{
+				return std::nullopt;
+			}
+
+			// MigrationPlan::apply reads fields in place from records of the schema's size
+			if (field.offset > schema.size || field.size > schema.size - field.offset) {
+				return std::nullopt;
+			}
+
+			field.trivially_copyable = trivially_copyable != 0;
+			schema.fields.push_back(std::move(field));
+		}
+
+		if (!reader.data.empty() || schema.fingerprint != fingerprint_fields(schema.size, schema.fields)) {
+			return std::nullopt;
+		}
+
+		return schema;
+	}
+
+
+
+	auto make_migration_plan(Kernel const& kernel, StoredSchema const& old_schema, StructDef const& struct_def) -> MigrationPlan {
+		auto const current_schema = capture_schema(kernel, struct_def);
+		bool const trivially_copyable = struct_def.lifecycle.trivially_copyable;
+
+		MigrationPlan plan {
+			&struct_def,
+			old_schema.size,
+			trivially_copyable && old_schema.fingerprint == current_schema.fingerprint,
+			{}, {}, {}, {}, {},
+		};
+
+		if (plan.identical) {
+			return plan;
+		}
+
+		// Trivially copyable structs start from a full copy of the default value, so only
+		// non-trivial structs need per field defaults
+		if (trivially_copyable) {
+			plan.defaults.push_back({0, 0, static_cast<std::uint32_t>(struct_def.size)});
+		}
+
+		for (auto const& field : current_schema.fields) {
+			auto const old_it = std::find_if(
+				old_schema.fields.begin(), old_schema.fields.end(),
+				[&field] (auto&& old_field) { return old_field.path == field.path; }
+			);
+
+			bool const migratable = old_it != old_schema.fields.end()
+				&& old_it->trivially_copyable
+				&& field.trivially_copyable;
+
+			if (migratable && old_it->type_name == field.type_name && old_it->size == field.size) {
+				plan.copies.push_back({old_it->offset, field.offset, field.size});
+				continue;
+			}
+
+			if (migratable && old_it->type_name == "Int" && field.type_name == "Float") {
+				plan.conversions.push_back({old_it->offset, field.offset, MigrationPlan::Conversion::IntToFloat});
+				continue;
+			}
+
+			if (migratable && old_it->type_name == "Float" && field.type_name == "Int") {
+				plan.conversions.push_back({old_it->offset, field.offset, MigrationPlan::Conversion::FloatToInt});
+				continue;
+			}
+
+			plan.defaulted_fields.push_back(field.path);
+
+			if (!trivially_copyable && field.trivially_copyable) {
+				plan.defaults.push_back({field.offset, field.offset, field.size});
+			}
+		}
+
+		for (auto const& old_field : old_schema.fields) {
+			auto const current_it = std::find_if(
+				current_schema.fields.begin(), current_schema.fields.end(),
+				[&old_field] (auto&& field) { return field.path == old_field.path; }
+			);
+
+			if (current_it == current_schema.fields.end()) {
+				plan.dropped_fields.push_back(old_field.path);
+			}
+		}
+
+		merge_ranges(plan.copies);
+		merge_ranges(plan.defaults);
+
+		return plan;
+	}
+
+
+
+	void MigrationPlan::apply(std::byte const* src_records, std::size_t count, std::byte* dst) const {
+		auto const dst_stride = this->struct_def->size;
+
+		if (this->identical) {
+			std::memcpy(dst, src_records, count * dst_stride);
+			return;
+		}
+
+		auto const default_ptr = this->struct_def->default_value.get();
+
+		for (std::size_t record = 0; record < count; record++) {
+			auto const src_ptr = src_records + record * this->src_stride;
+			auto const dst_ptr = dst + record * dst_stride;
+
+			for (auto const& range : this->defaults) {
+				std::memcpy(dst_ptr + range.dst_offset, default_ptr + range.src_offset, range.size);
+			}
+
+			for (auto const& range : this->copies) {
+				std::memcpy(dst_ptr + range.dst_offset, src_ptr + range.src_offset, range.size);
+			}
+
+			for (auto const& field : this->conversions) {
+				switch (field.conversion) {
+					case Conversion::IntToFloat: {
+						int value;
+						std::memcpy(&value, src_ptr + field.src_offset, sizeof value);
+						auto const converted = static_cast<float>(value);
+						std::memcpy(dst_ptr + field.dst_offset, &converted, sizeof converted);
+						break;
+					}
+
+					case Conversion::FloatToInt: {
+						float value;
+						std::memcpy(&value, src_ptr + field.src_offset, sizeof value);
+
+						// Out of range and NaN values would be UB to convert
+						constexpr auto int_min = static_cast<float>(std::numeric_limits<int>::min());
+						constexpr auto int_max = static_cast<float>(std::numeric_limits<int>::max());
+						auto const converted = (value >= int_min && value < int_max) ? static_cast<int>(value) : 0;
+						std::memcpy(dst_ptr + field.dst_offset, &converted, sizeof converted);
+						break;
+					}
+				}
+			}
+		}
+	}
+
+}
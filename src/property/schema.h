@@ -0,0 +1,91 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace property {
+
+	using SchemaFingerprint = std::uint64_t;
+
+
+	// A leaf field of a struct, with nested structs flattened into '/' separated paths.
+	// Types are identified by name rather than TypeId, since custom TypeIds aren't stable between runs
+	struct StoredFieldSchema {
+		std::string path;
+		std::string type_name;
+		std::uint32_t offset;
+		std::uint32_t size;
+		bool trivially_copyable;
+	};
+
+	// The layout of a struct at the time its data was saved
+	struct StoredSchema {
+		std::string name;
+		std::uint32_t size;
+		std::vector<StoredFieldSchema> fields;
+		SchemaFingerprint fingerprint;
+	};
+
+
+	// Stable name for a field's type, e.g., "Int", "Blah" for registered types, or "List<Int>"
+	std::string type_name(Kernel const& kernel, FieldDef const& field_def);
+
+	auto capture_schema(Kernel const& kernel, StructDef const& struct_def) -> StoredSchema;
+	auto schema_fingerprint(Kernel const& kernel, StructDef const& struct_def) -> SchemaFingerprint;
+
+	// Appends a self contained binary form of schema to buffer, e.g., to store alongside saved records.
+	// Values are stored in native byte order
+	void write_schema(StoredSchema const& schema, std::vector<std::byte>& buffer);
+	// The inverse of write_schema. Returns nullopt if data isn't exactly one written schema, its fingerprint
+	// doesn't match its fields, or a field lies outside the struct
+	auto read_schema(std::span<std::byte const> data) -> std::optional<StoredSchema>;
+
+
+	// Precomputed conversion from records saved with an old schema to the current StructDef.
+	// Only trivially copyable leaf fields can be migrated out of raw records; everything else is left
+	// as constructed in the destination.
+	struct MigrationPlan {
+		struct CopyRange {
+			std::uint32_t src_offset;
+			std::uint32_t dst_offset;
+			std::uint32_t size;
+		};
+
+		enum class Conversion {
+			IntToFloat,
+			FloatToInt,
+		};
+
+		struct ConvertedField {
+			std::uint32_t src_offset;
+			std::uint32_t dst_offset;
+			Conversion conversion;
+		};
+
+		StructDef const* struct_def;
+		std::size_t src_stride;
+
+		// Old schema matches the current one exactly, so records can be copied wholesale
+		bool identical;
+
+		std::vector<CopyRange> copies;
+		std::vector<ConvertedField> conversions;
+		// Ranges of the default value to copy into fields that are new or couldn't be migrated
+		std::vector<CopyRange> defaults;
+
+		std::vector<std::string> defaulted_fields;
+		std::vector<std::string> dropped_fields;
+
+		// dst must point to count constructed instances of struct_def, or to uninitialised storage
+		// if the struct is trivially copyable
+		void apply(std::byte const* src_records, std::size_t count, std::byte* dst) const;
+	};
+
+	auto make_migration_plan(Kernel const& kernel, StoredSchema const& old_schema, StructDef const& struct_def) -> MigrationPlan;
+
+} // property
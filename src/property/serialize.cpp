@@ -0,0 +1,645 @@
+#include "property/serialize.h"
+#include "property/hash.h"
+#include "property/internal/value_access.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <fmt/core.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace property {
+
+	namespace {
+		constexpr std::size_t payload_alignment = alignof(std::max_align_t);
+
+		// Record layouts are described by a HashPlan, which already flattens nested structs into
+		// runs of trivially copyable bytes, strings and lists
+		struct Writer {
+			std::vector<std::byte>& buffer;
+
+			std::uint64_t reserve(std::size_t size, std::size_t alignment) {
+				auto const offset = (this->buffer.size() + alignment - 1) / alignment * alignment;
+				this->buffer.resize(offset + size, std::byte{0});
+				return offset;
+			}
+
+			std::uint64_t append(std::byte const* data, std::size_t size, std::size_t alignment) {
+				auto const offset = this->reserve(size, alignment);
+				if (size > 0) {
+					std::memcpy(this->buffer.data() + offset, data, size);
+				}
+				return offset;
+			}
+
+			void write_span(std::uint64_t at, SerializedSpan span) {
+				std::memcpy(this->buffer.data() + at, &span, sizeof span);
+			}
+
+			std::uint64_t append_string(std::string const& string) {
+				return this->append(reinterpret_cast<std::byte const*>(string.data()), string.size(), 1);
+			}
+
+			void write_record(HashPlan const& plan, std::byte const* src, std::uint64_t record_offset) {
+				for (auto const& op : plan.ops) {
+					auto const field_ptr = src + op.offset;
+					auto const dst_offset = record_offset + op.offset;
+
+					switch (op.kind) {
+						case HashPlan::OpKind::Bytes:
+							std::memcpy(this->buffer.data() + dst_offset, field_ptr, op.size);
+							break;
+
+						case HashPlan::OpKind::String: {
+							auto const& string = internal::read_string(field_ptr);
+							auto const payload_offset = this->append_string(string);
+							this->write_span(dst_offset, {payload_offset, string.size()});
+							break;
+						}
+
+						case HashPlan::OpKind::List:
+							this->write_list(plan, op, field_ptr, dst_offset);
+							break;
+					}
+				}
+			}
+
+			void write_list(HashPlan const& plan, HashPlan::Op const& op, std::byte const* field_ptr, std::uint64_t dst_offset) {
+				auto const& list_info = *op.list_info;
+				auto const list_size = list_info.get_size(field_ptr);
+				auto const element_size = list_info.element_size;
+
+				std::uint64_t payload_offset = 0;
+
+				if (auto const element_plan = plan.element_plan_for(op)) {
+					auto const element_struct_id = plan.kernel->struct_id_from_type_id(list_info.element_type_id);
+					auto const element_alignment = plan.kernel->struct_def_for(*element_struct_id)->alignment;
+					payload_offset = this->reserve(list_size * element_size, std::max(payload_alignment, element_alignment));
+
+					for (std::size_t idx = 0; idx < list_size; idx++) {
+						this->write_record(*element_plan, list_info.get_element_ptr(field_ptr, idx), payload_offset + idx * element_size);
+					}
+
+				} else if (list_info.element_type_id == TypeId::String) {
+					payload_offset = this->reserve(list_size * sizeof(SerializedSpan), alignof(SerializedSpan));
+
+					for (std::size_t idx = 0; idx < list_size; idx++) {
+						auto const& string = internal::read_string(list_info.get_element_ptr(field_ptr, idx));
+						auto const string_offset = this->append_string(string);
+						this->write_span(payload_offset + idx * sizeof(SerializedSpan), {string_offset, string.size()});
+					}
+
+				} else if (list_info.contiguous && list_size > 0) {
+					payload_offset = this->append(list_info.get_element_ptr(field_ptr, 0), list_size * element_size, payload_alignment);
+
+				} else {
+					payload_offset = this->reserve(list_size * element_size, payload_alignment);
+
+					for (std::size_t idx = 0; idx < list_size; idx++) {
+						auto const element_ptr = list_info.get_element_ptr(field_ptr, idx);
+						std::memcpy(this->buffer.data() + payload_offset + idx * element_size, element_ptr, element_size);
+					}
+				}
+
+				this->write_span(dst_offset, {payload_offset, list_size});
+			}
+		};
+
+
+		bool span_in_bounds(std::span<std::byte const> buffer, SerializedSpan span, std::size_t element_size) {
+			if (span.offset > buffer.size()) {
+				return false;
+			}
+
+			auto const available = buffer.size() - span.offset;
+			return element_size == 0 || span.size <= available / element_size;
+		}
+
+
+		bool is_aligned(std::byte const* ptr, std::size_t alignment) {
+			return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+		}
+
+
+		// The inverse of Writer, following the same HashPlan
+		struct Reader {
+			std::span<std::byte const> buffer;
+
+			std::optional<SerializedSpan> read_span(std::byte const* src, std::size_t element_size) const {
+				SerializedSpan span;
+				std::memcpy(&span, src, sizeof span);
+
+				if (!span_in_bounds(this->buffer, span, element_size)) {
+					return std::nullopt;
+				}
+
+				return span;
+			}
+
+			bool read_string(std::byte const* src, std::byte* dst) const {
+				auto const span = this->read_span(src, 1);
+				if (!span) {
+					return false;
+				}
+
+				auto const data = reinterpret_cast<char const*>(this->buffer.data() + span->offset);
+				internal::read_string_mut(dst).assign(data, span->size);
+				return true;
+			}
+
+			bool read_record(HashPlan const& plan, std::byte const* src, std::byte* dst) const {
+				for (auto const& op : plan.ops) {
+					switch (op.kind) {
+						case HashPlan::OpKind::Bytes:
+							std::memcpy(dst + op.offset, src + op.offset, op.size);
+							break;
+
+						case HashPlan::OpKind::String:
+							if (!this->read_string(src + op.offset, dst + op.offset)) {
+								return false;
+							}
+							break;
+
+						case HashPlan::OpKind::List:
+							if (!this->read_list(plan, op, src + op.offset, dst + op.offset)) {
+								return false;
+							}
+							break;
+					}
+				}
+
+				return true;
+			}
+
+			bool read_list(HashPlan const& plan, HashPlan::Op const& op, std::byte const* src, std::byte* field_ptr) const {
+				auto const& list_info = *op.list_info;
+				auto const element_plan = plan.element_plan_for(op);
+				bool const is_string_list = !element_plan && list_info.element_type_id == TypeId::String;
+				auto const element_size = is_string_list ? sizeof(SerializedSpan) : list_info.element_size;
+
+				auto const span = this->read_span(src, element_size);
+				if (!span || !list_info.resize(field_ptr, span->size)) {
+					return false;
+				}
+
+				auto const payload = this->buffer.data() + span->offset;
+				auto const list_size = span->size;
+
+				// Writer always places element records after the record holding the list. Requiring that here means
+				// a crafted buffer can't make a recursive list contain itself
+				if (element_plan && list_size > 0 && payload <= src) {
+					return false;
+				}
+
+				if (element_plan) {
+					for (std::size_t idx = 0; idx < list_size; idx++) {
+						if (!this->read_record(*element_plan, payload + idx * element_size, list_info.get_element_ptr(field_ptr, idx))) {
+							return false;
+						}
+					}
+
+				} else if (is_string_list) {
+					for (std::size_t idx = 0; idx < list_size; idx++) {
+						if (!this->read_string(payload + idx * element_size, list_info.get_element_ptr(field_ptr, idx))) {
+							return false;
+						}
+					}
+
+				} else if (list_info.contiguous && list_size > 0) {
+					std::memcpy(list_info.get_element_ptr(field_ptr, 0), payload, list_size * element_size);
+
+				} else {
+					for (std::size_t idx = 0; idx < list_size; idx++) {
+						std::memcpy(list_info.get_element_ptr(field_ptr, idx), payload + idx * element_size, element_size);
+					}
+				}
+
+				return true;
+			}
+		};
+	}
+
+
+	bool can_serialize(HashPlan const& plan) {
+		return plan.complete && std::all_of(plan.ops.begin(), plan.ops.end(), [] (HashPlan::Op const& op) {
+			return op.kind == HashPlan::OpKind::Bytes || op.size >= sizeof(SerializedSpan);
+		}) && std::all_of(plan.element_plans.begin(), plan.element_plans.end(), [] (HashPlan const& element_plan) {
+			return can_serialize(element_plan);
+		});
+	}
+
+
+	auto serialize(Kernel const& kernel, StructDef const& struct_def, std::byte const* instances, std::size_t count)
+		-> std::optional<std::vector<std::byte>>
+	{
+		auto const plan = make_hash_plan(kernel, struct_def);
+		if (!can_serialize(plan)) {
+			return std::nullopt;
+		}
+
+		auto const stride = struct_def.size;
+
+		std::vector<std::byte> buffer;
+		Writer writer {buffer};
+
+		auto const schema = capture_schema(kernel, struct_def);
+
+		auto const header_offset = writer.reserve(sizeof(SerializedHeader), 1);
+		auto const name_offset = writer.append(reinterpret_cast<std::byte const*>(struct_def.name.data()), struct_def.name.size(), 1);
+		auto const schema_offset = buffer.size();
+		write_schema(schema, buffer);
+		auto const schema_size = buffer.size() - schema_offset;
+		auto const records_offset = writer.reserve(count * stride, std::max(payload_alignment, struct_def.alignment));
+
+		for (std::size_t idx = 0; idx < count; idx++) {
+			writer.write_record(plan, instances + idx * stride, records_offset + idx * stride);
+		}
+
+		SerializedHeader const header {
+			SerializedHeader::expected_magic,
+			SerializedHeader::current_version,
+			schema.fingerprint,
+			count,
+			stride,
+			{records_offset, count * stride},
+			{name_offset, struct_def.name.size()},
+			{schema_offset, schema_size},
+		};
+
+		std::memcpy(buffer.data() + header_offset, &header, sizeof header);
+		return buffer;
+	}
+
+
+	bool deserialize(Kernel const& kernel, SerializedBuffer const& buffer, StructMutSpan instances) {
+		return deserialize(make_hash_plan(kernel, *instances.struct_def), buffer, instances);
+	}
+
+
+	bool deserialize(HashPlan const& plan, SerializedBuffer const& buffer, StructMutSpan instances) {
+		if (instances.count > buffer.header.record_count || buffer.header.record_stride != instances.struct_def->size
+			|| !can_serialize(plan))
+		{
+			return false;
+		}
+
+		auto const stride = instances.struct_def->size;
+
+		for (std::size_t idx = 0; idx < instances.count; idx++) {
+			if (!deserialize_record(plan, buffer, idx, instances.data + idx * stride)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	bool deserialize_record(HashPlan const& plan, SerializedBuffer const& buffer, std::size_t record_idx, std::byte* instance) {
+		if (record_idx >= buffer.header.record_count) {
+			return false;
+		}
+
+		Reader const reader {buffer.data};
+		auto const record = buffer.data.data() + buffer.header.records.offset + record_idx * buffer.header.record_stride;
+		return reader.read_record(plan, record, instance);
+	}
+
+
+	bool migrate_record(MigrationPlan const& plan, SerializedBuffer const& buffer, std::size_t record_idx, std::byte* instance) {
+		if (record_idx >= buffer.header.record_count || plan.src_stride != buffer.header.record_stride) {
+			return false;
+		}
+
+		auto const record = buffer.data.data() + buffer.header.records.offset + record_idx * buffer.header.record_stride;
+		plan.apply(record, 1, instance);
+		return true;
+	}
+
+
+
+	std::optional<std::span<std::byte const>> SerializedFieldRef::resolve_span(std::size_t element_size, std::size_t element_alignment) const {
+		SerializedSpan span;
+		std::memcpy(&span, this->field_ptr, sizeof span);
+
+		if (!span_in_bounds(this->buffer, span, element_size) || !is_aligned(this->buffer.data() + span.offset, element_alignment)) {
+			return std::nullopt;
+		}
+
+		return this->buffer.subspan(span.offset, span.size * element_size);
+	}
+
+
+	std::optional<std::string_view> SerializedFieldRef::try_read_string() const {
+		if (this->field_def->list_info || this->field_def->field_info.type_id != TypeId::String) {
+			return std::nullopt;
+		}
+
+		if (auto string = this->resolve_span(1, 1)) {
+			return std::string_view{reinterpret_cast<char const*>(string->data()), string->size()};
+		}
+
+		return std::nullopt;
+	}
+
+
+	std::optional<std::size_t> SerializedFieldRef::list_size() const {
+		auto const& list_info = this->field_def->list_info;
+		if (!list_info) {
+			return std::nullopt;
+		}
+
+		// Lists of strings store a SerializedSpan per element
+		auto const element_size = (list_info->element_type_id == TypeId::String) ? sizeof(SerializedSpan) : list_info->element_size;
+		if (auto elements = this->resolve_span(element_size, 1)) {
+			return elements->size() / element_size;
+		}
+
+		return std::nullopt;
+	}
+
+
+	std::optional<SerializedStructRef> SerializedFieldRef::list_struct_element(Kernel const& kernel, std::size_t idx) const {
+		auto const& list_info = this->field_def->list_info;
+		if (!list_info) {
+			return std::nullopt;
+		}
+
+		auto const struct_id = kernel.struct_id_from_type_id(list_info->element_type_id);
+		if (!struct_id) {
+			return std::nullopt;
+		}
+
+		auto const element_def = kernel.struct_def_for(*struct_id);
+		auto const elements = this->resolve_span(list_info->element_size, element_def->alignment);
+		if (!elements || idx >= elements->size() / list_info->element_size) {
+			return std::nullopt;
+		}
+
+		return SerializedStructRef {
+			element_def,
+			this->buffer,
+			elements->data() + idx * list_info->element_size,
+		};
+	}
+
+
+
+	auto SerializedBuffer::open(std::span<std::byte const> data) -> std::optional<SerializedBuffer> {
+		if (data.size() < sizeof(SerializedHeader)) {
+			return std::nullopt;
+		}
+
+		SerializedHeader header;
+		std::memcpy(&header, data.data(), sizeof header);
+
+		if (header.magic != SerializedHeader::expected_magic || header.version != SerializedHeader::current_version) {
+			return std::nullopt;
+		}
+
+		if (!span_in_bounds(data, header.records, 1) || !span_in_bounds(data, header.struct_name, 1)
+			|| !span_in_bounds(data, header.schema, 1))
+		{
+			return std::nullopt;
+		}
+
+		if (header.record_stride == 0 || header.records.size / header.record_stride < header.record_count) {
+			return std::nullopt;
+		}
+
+		// Records and list payloads are read in place, so must be aligned as serialize wrote them
+		if (!is_aligned(data.data(), payload_alignment) || header.records.offset % payload_alignment != 0) {
+			return std::nullopt;
+		}
+
+		return SerializedBuffer {data, header};
+	}
+
+
+	std::string_view SerializedBuffer::struct_name() const {
+		auto const name_ptr = reinterpret_cast<char const*>(this->data.data() + this->header.struct_name.offset);
+		return {name_ptr, this->header.struct_name.size};
+	}
+
+
+	bool SerializedBuffer::matches(Kernel const& kernel, StructDef const& struct_def) const {
+		return this->header.record_stride == struct_def.size
+			&& this->header.fingerprint == schema_fingerprint(kernel, struct_def);
+	}
+
+
+	auto SerializedBuffer::schema() const -> std::optional<StoredSchema> {
+		auto schema = read_schema(this->data.subspan(this->header.schema.offset, this->header.schema.size));
+		if (!schema || schema->name != this->struct_name() || schema->size != this->header.record_stride
+			|| schema->fingerprint != this->header.fingerprint)
+		{
+			return std::nullopt;
+		}
+
+		return schema;
+	}
+
+
+	auto SerializedBuffer::record(StructDef const* struct_def, std::size_t idx) const -> std::optional<SerializedStructRef> {
+		if (idx >= this->header.record_count) {
+			return std::nullopt;
+		}
+
+		// open only checks payload_alignment, which over-aligned structs exceed
+		auto const record_ptr = this->data.data() + this->header.records.offset + idx * this->header.record_stride;
+		if (!is_aligned(record_ptr, struct_def->alignment)) {
+			return std::nullopt;
+		}
+
+		return SerializedStructRef {
+			struct_def,
+			this->data,
+			record_ptr,
+		};
+	}
+
+
+
+	auto MappedFile::open(std::string const& path) -> std::optional<MappedFile> {
+		auto const fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return std::nullopt;
+		}
+
+		struct stat file_stat;
+		if (::fstat(fd, &file_stat) != 0) {
+			::close(fd);
+			return std::nullopt;
+		}
+
+		auto const size = static_cast<std::size_t>(file_stat.st_size);
+		if (size == 0) {
+			::close(fd);
+			return MappedFile {nullptr, 0};
+		}
+
+		auto const mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+
+		if (mapping == MAP_FAILED) {
+			return std::nullopt;
+		}
+
+		return MappedFile {static_cast<std::byte const*>(mapping), size};
+	}
+
+
+	MappedFile::MappedFile(MappedFile&& other)
+		: mapping {std::exchange(other.mapping, nullptr)}
+		, size {std::exchange(other.size, 0)}
+	{}
+
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) {
+		if (this != &other) {
+			if (this->mapping) {
+				::munmap(const_cast<std::byte*>(this->mapping), this->size);
+			}
+
+			this->mapping = std::exchange(other.mapping, nullptr);
+			this->size = std::exchange(other.size, 0);
+		}
+
+		return *this;
+	}
+
+
+	MappedFile::~MappedFile() {
+		if (this->mapping) {
+			::munmap(const_cast<std::byte*>(this->mapping), this->size);
+		}
+	}
+
+
+
+	static void inspect_impl(Kernel const& kernel, SerializedStructRef struct_ref, int indent);
+
+	static std::string format_serialized_field(SerializedFieldRef field_ref) {
+		auto const field_def = field_ref.field_def;
+
+		if (auto list_size = field_ref.list_size()) {
+			return fmt::format("<list of {}>", *list_size);
+		}
+
+		if (auto string = field_ref.try_read_string()) {
+			return std::string{*string};
+		}
+
+		if (field_def->field_info.trivially_copyable) {
+			return field_def->field_info.format(field_ref.field_ptr);
+		}
+
+		return "<unavailable>";
+	}
+
+	static void inspect_impl(Kernel const& kernel, SerializedFieldRef field_ref, int indent) {
+		auto const field_def = field_ref.field_def;
+		auto const field_str = format_serialized_field(field_ref);
+
+		fmt::print("{:{}}field \"{}\" ({})\n", "", indent*4, field_def->display_name, field_def->name);
+		fmt::print("{:{}}description: {}\n", "", indent*4, field_def->description);
+		fmt::print("{:{}}type: {}\n", "", indent*4, field_def->field_info.type_id);
+		fmt::print("{:{}}contents: {}\n", "", indent*4, field_str);
+
+
+		if (!field_def->attributes.empty()) {
+			fmt::print("{:{}}attributes: ", "", indent*4);
+
+			for (auto attribute_ref : field_def->attributes) {
+				fmt::print("{}, ", attribute_ref.data->format());
+			}
+
+			fmt::print("\n");
+		}
+
+		if (auto child_struct_id = kernel.struct_id_from_type_id(field_def->field_info.type_id)) {
+			auto const struct_def = kernel.struct_def_for(*child_struct_id);
+			inspect_impl(kernel, SerializedStructRef{struct_def, field_ref.buffer, field_ref.field_ptr}, indent+1);
+		}
+		if (auto child_enum_id = kernel.enum_id_from_type_id(field_def->field_info.type_id)) {
+			auto const enum_def = kernel.enum_def_for(*child_enum_id);
+			fmt::print("{:{}}enum \"{}\" ", "", (indent+1)*4, enum_def->name);
+
+			for (auto const& variant_def : enum_def->variants) {
+				fmt::print("(\"{}\", {}) ", variant_def.display_name, variant_def.value);
+			}
+
+			fmt::print("\n");
+		}
+
+		fmt::print("\n");
+	}
+
+	static void inspect_impl(Kernel const& kernel, SerializedStructRef struct_ref, int indent) {
+		auto const [struct_def, buffer, struct_ptr] = struct_ref;
+
+		fmt::print("{:{}}serialized struct \"{}\" (id: {}, size: {}):\n", "", indent*4, struct_def->name, struct_def->id, struct_def->size);
+
+		for (auto const& field_def : struct_def->fields) {
+			auto const field_ptr = struct_ptr + field_def.field_info.offset;
+			inspect_impl(kernel, SerializedFieldRef{struct_def->id, &field_def, buffer, field_ptr}, indent+1);
+		}
+	}
+
+	void inspect(Kernel const& kernel, SerializedStructRef struct_ref) {
+		inspect_impl(kernel, struct_ref, 0);
+	}
+
+	void inspect(Kernel const& kernel, SerializedFieldRef field_ref) {
+		inspect_impl(kernel, field_ref, 0);
+	}
+
+
+
+	std::optional<SerializedFieldRef> resolve_field_path(Kernel const& kernel, SerializedStructRef struct_ref, std::string_view field_path) {
+		if (field_path.empty()) {
+			return std::nullopt;
+		}
+
+		auto [struct_def, buffer, field_ptr] = struct_ref;
+
+		while (true) {
+			auto const [path_segment, tail] = split(field_path, '/');
+			field_path = tail;
+
+			auto const field_it = std::find_if(
+				struct_def->fields.begin(), struct_def->fields.end(),
+				[path_segment=path_segment] (auto&& field_def) {
+					return field_def.name == path_segment;
+				}
+			);
+
+			if (field_it == struct_def->fields.end()) {
+				return std::nullopt;
+			}
+
+			field_ptr += field_it->field_info.offset;
+
+			if (field_path.empty()) {
+				return SerializedFieldRef {
+					struct_def->id,
+					&*field_it,
+					buffer,
+					field_ptr,
+				};
+			}
+
+			if (auto struct_id = kernel.struct_id_from_type_id(field_it->field_info.type_id)) {
+				struct_def = kernel.struct_def_for(*struct_id);
+			} else {
+				return std::nullopt;
+			}
+		}
+	}
+
+}
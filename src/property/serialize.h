@@ -0,0 +1,164 @@
+#pragma once
+
+#include "property/property.h"
+#include "property/schema.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace property {
+
+	// Serialized records share the in-memory layout of their struct, so FieldTypeInfo::offset is valid for both.
+	// Trivially copyable fields are stored in place, while strings and lists are replaced by a SerializedSpan
+	// pointing elsewhere in the same buffer. Padding is zeroed. Values are stored in native byte order.
+	//
+	// Buffer layout: SerializedHeader, struct name, the struct's StoredSchema as written by write_schema, records,
+	// then string and list payloads. The schema lets records saved by an older version be migrated.
+	struct SerializedSpan {
+		std::uint64_t offset;
+		std::uint64_t size;
+	};
+
+	struct SerializedHeader {
+		static constexpr std::uint32_t expected_magic = 0x53505250; // "PRPS"
+		static constexpr std::uint32_t current_version = 2;
+
+		std::uint32_t magic;
+		std::uint32_t version;
+		SchemaFingerprint fingerprint;
+		std::uint64_t record_count;
+		std::uint64_t record_stride;
+		SerializedSpan records;
+		SerializedSpan struct_name;
+		SerializedSpan schema;
+	};
+
+
+	struct HashPlan;
+	struct SerializedBuffer;
+
+	// Whether the plan is complete, and every string and list field in it, including those of list elements, is
+	// large enough to hold a SerializedSpan in place. Structs that fail can't be serialized
+	bool can_serialize(HashPlan const& plan);
+
+	// Serializes count contiguous instances of struct_def. Returns nullopt if the struct fails can_serialize
+	auto serialize(Kernel const& kernel, StructDef const& struct_def, std::byte const* instances, std::size_t count)
+		-> std::optional<std::vector<std::byte>>;
+
+	// Reads the first instances.count records back into constructed instances; the inverse of serialize.
+	// The buffer must match instances.struct_def, and hold at least instances.count records.
+	// Returns false if the struct fails can_serialize, a string or list span is out of bounds, or a list can't
+	// be resized, in which case instances may be partially written.
+	bool deserialize(Kernel const& kernel, SerializedBuffer const& buffer, StructMutSpan instances);
+	// As above, with the plan from make_hash_plan(kernel, *instances.struct_def) built once up front
+	bool deserialize(HashPlan const& plan, SerializedBuffer const& buffer, StructMutSpan instances);
+	// Reads a single record into a constructed instance of the buffer's struct. The plan must pass can_serialize
+	bool deserialize_record(HashPlan const& plan, SerializedBuffer const& buffer, std::size_t record_idx, std::byte* instance);
+
+	// Reads a single record saved with an older schema into a constructed instance of plan.struct_def, where plan is
+	// from make_migration_plan with the buffer's schema(). Only fields the plan migrates are read, so strings and
+	// lists keep their constructed values. Returns false if record_idx is out of range or the plan is for another stride
+	bool migrate_record(MigrationPlan const& plan, SerializedBuffer const& buffer, std::size_t record_idx, std::byte* instance);
+
+
+
+	struct SerializedStructRef;
+
+	// A field of a serialized record. Fixed size fields are read in place, with no copying
+	struct SerializedFieldRef {
+		StructId struct_id;
+		FieldDef const* field_def;
+		std::span<std::byte const> buffer;
+		std::byte const* field_ptr;
+
+
+		// Only valid for trivially copyable fields
+		template<class F>
+		F const* try_read() const;
+
+		std::optional<std::string_view> try_read_string() const;
+
+		// Only valid for lists of trivially copyable, unregistered elements
+		template<class E>
+		std::optional<std::span<E const>> try_read_list() const;
+
+		std::optional<std::size_t> list_size() const;
+		std::optional<SerializedStructRef> list_struct_element(Kernel const& kernel, std::size_t idx) const;
+
+
+		template<class A>
+		bool has_attribute() const;
+
+		template<class A>
+		A const* get_attribute() const;
+
+	private:
+		// Returns nullopt if the span is out of bounds or its payload isn't aligned to element_alignment
+		std::optional<std::span<std::byte const>> resolve_span(std::size_t element_size, std::size_t element_alignment) const;
+	};
+
+	struct SerializedStructRef {
+		StructDef const* struct_def;
+		std::span<std::byte const> buffer;
+		std::byte const* struct_ptr;
+	};
+
+
+	// A validated view over a serialized buffer, e.g., a MappedFile
+	struct SerializedBuffer {
+		std::span<std::byte const> data;
+		SerializedHeader header;
+
+		// Returns nullopt if data isn't a well formed serialized buffer, or data or its records aren't aligned
+		// to alignof(std::max_align_t). Buffers from new, std::vector or a MappedFile are
+		static auto open(std::span<std::byte const> data) -> std::optional<SerializedBuffer>;
+
+		std::string_view struct_name() const;
+		bool matches(Kernel const& kernel, StructDef const& struct_def) const;
+
+		// The schema the records were saved with. Returns nullopt if it isn't well formed, or doesn't describe
+		// the buffer's struct and record stride
+		auto schema() const -> std::optional<StoredSchema>;
+
+		auto size() const { return header.record_count; }
+
+		// struct_def must match the buffer's schema. Returns nullopt if idx is out of range, or the record isn't
+		// aligned for struct_def
+		auto record(StructDef const* struct_def, std::size_t idx) const -> std::optional<SerializedStructRef>;
+	};
+
+
+	// Read only memory mapping of a file. Pages are only read as they're touched
+	struct MappedFile {
+		static auto open(std::string const& path) -> std::optional<MappedFile>;
+
+		MappedFile(MappedFile&&);
+		MappedFile& operator=(MappedFile&&);
+		~MappedFile();
+
+		MappedFile(MappedFile const&) = delete;
+		MappedFile& operator=(MappedFile const&) = delete;
+
+		auto data() const -> std::span<std::byte const> { return {mapping, size}; }
+
+	private:
+		MappedFile(std::byte const* mapping, std::size_t size) : mapping{mapping}, size{size} {}
+
+		std::byte const* mapping;
+		std::size_t size;
+	};
+
+
+	void inspect(Kernel const& kernel, SerializedStructRef struct_ref);
+	void inspect(Kernel const& kernel, SerializedFieldRef field_ref);
+
+	std::optional<SerializedFieldRef> resolve_field_path(Kernel const& kernel, SerializedStructRef struct_ref, std::string_view field_path);
+
+} // property
+
+
+#include "property/serialize.inl"
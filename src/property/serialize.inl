@@ -0,0 +1,36 @@
+namespace property {
+
+	template<class F>
+	F const* SerializedFieldRef::try_read() const {
+		auto const& field_info = this->field_def->field_info;
+		if (!field_info.trivially_copyable || !field_info.matches_type<F>()) {
+			return nullptr;
+		}
+
+		return std::launder(reinterpret_cast<F const*>(this->field_ptr));
+	}
+
+
+	template<class E>
+	std::optional<std::span<E const>> SerializedFieldRef::try_read_list() const {
+		auto const& list_info = this->field_def->list_info;
+		if (!list_info || !list_info->element_trivially_copyable || list_info->element_type_id != property::type_id<E>()) {
+			return std::nullopt;
+		}
+
+		if (auto elements = this->resolve_span(sizeof(E), alignof(E))) {
+			auto const element_ptr = std::launder(reinterpret_cast<E const*>(elements->data()));
+			return std::span<E const>{element_ptr, elements->size() / sizeof(E)};
+		}
+
+		return std::nullopt;
+	}
+
+
+	template<class A>
+	bool SerializedFieldRef::has_attribute() const { return this->field_def->attributes.has_attribute<A>(); }
+
+	template<class A>
+	A const* SerializedFieldRef::get_attribute() const { return this->field_def->attributes.get_attribute<A>(); }
+
+} // property
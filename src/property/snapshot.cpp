@@ -0,0 +1,299 @@
+#include "property/snapshot.h"
+
+#include <new>
+#include <unordered_set>
+
+namespace property {
+
+	namespace {
+		std::byte* allocate_node_data(std::size_t size, std::size_t alignment) {
+			return static_cast<std::byte*>(::operator new(size, std::align_val_t{alignment}));
+		}
+
+
+		// Copies the fields a struct node stores itself, i.e., those without a child node.
+		// Returns false if any of them isn't copy assignable
+		bool copy_plain_fields(StructDef const& struct_def, std::vector<std::shared_ptr<SnapshotNode const>> const& children,
+			std::byte* dst, std::byte const* src)
+		{
+			bool copied_all = true;
+
+			for (auto const& field_def : struct_def.fields) {
+				if (!children[field_def.idx]) {
+					auto const offset = field_def.field_info.offset;
+					copied_all &= field_def.field_info.copy_assign(dst + offset, src + offset);
+				}
+			}
+
+			return copied_all;
+		}
+
+
+		// Returns null if any field can't be copied, since copying its node on write would silently reset it
+		auto build_node(Kernel const& kernel, StructDef const& struct_def, std::byte const* src) -> std::shared_ptr<SnapshotNode> {
+			auto node = std::make_shared<SnapshotNode>(&struct_def);
+
+			for (auto const& field_def : struct_def.fields) {
+				auto const field_ptr = src + field_def.field_info.offset;
+				auto& child = node->children[field_def.idx];
+
+				if (field_def.list_info) {
+					child = std::make_shared<SnapshotNode>(&field_def, field_ptr);
+					if (!child->data) {
+						return nullptr;
+					}
+				} else if (auto struct_id = kernel.struct_id_from_type_id(field_def.field_info.type_id)) {
+					child = build_node(kernel, *kernel.struct_def_for(*struct_id), field_ptr);
+					if (!child) {
+						return nullptr;
+					}
+				}
+			}
+
+			if (!copy_plain_fields(struct_def, node->children, node->data, src)) {
+				return nullptr;
+			}
+
+			return node;
+		}
+
+
+		bool materialize_node(SnapshotNode const& node, std::byte* dst) {
+			bool copied_all = true;
+
+			for (auto const& field_def : node.struct_def->fields) {
+				auto const& child = node.children[field_def.idx];
+				auto const offset = field_def.field_info.offset;
+
+				if (!child) {
+					copied_all &= field_def.field_info.copy_assign(dst + offset, node.data + offset);
+				} else if (child->list_field_def) {
+					copied_all &= child->data && field_def.field_info.copy_assign(dst + offset, child->data);
+				} else {
+					copied_all &= materialize_node(*child, dst + offset);
+				}
+			}
+
+			return copied_all;
+		}
+
+
+		template<class Data>
+		struct ResolvedNodeField {
+			// The struct directly containing the field
+			StructId struct_id;
+			FieldDef const* field_def;
+			Data field_ptr;
+		};
+
+
+		// Walks a path from field_idx_path through the nodes. get_child returns the node to continue into, and may replace it
+		template<class Node, class GetChild>
+		auto resolve_in_nodes(Node* node, std::span<FieldIdx const> field_idxs, GetChild&& get_child)
+			-> std::optional<ResolvedNodeField<decltype(node->data)>>
+		{
+			for (std::size_t segment = 0; segment < field_idxs.size(); segment++) {
+				auto const field_idx = field_idxs[segment];
+				auto const struct_id = node->struct_def->id;
+				auto const field_def = &node->struct_def->fields[field_idx];
+				bool const is_last = segment + 1 == field_idxs.size();
+
+				if (!node->children[field_idx]) {
+					return ResolvedNodeField<decltype(node->data)>{struct_id, field_def, node->data + field_def->field_info.offset};
+				}
+
+				node = get_child(node, field_idx);
+
+				if (is_last) {
+					if (!node->data) {
+						return std::nullopt;
+					}
+					return ResolvedNodeField<decltype(node->data)>{struct_id, field_def, node->data};
+				}
+			}
+
+			return std::nullopt;
+		}
+
+
+		void add_node_usage(SnapshotNode const* node, std::unordered_set<SnapshotNode const*>& visited, MemoryUsage& usage) {
+			if (!node || !visited.insert(node).second) {
+				return;
+			}
+
+			// make_shared allocates the node alongside its control block
+			usage.add(sizeof(SnapshotNode) + 2 * sizeof(void*));
+			if (node->data) {
+				usage.add(node->size());
+			}
+			if (node->children.capacity() > 0) {
+				usage.add(node->children.capacity() * sizeof(node->children[0]));
+			}
+
+			for (auto const& child : node->children) {
+				add_node_usage(child.get(), visited, usage);
+			}
+		}
+	}
+
+
+	SnapshotNode::SnapshotNode(StructDef const* struct_def)
+		: struct_def{struct_def}
+		, list_field_def{nullptr}
+		, data{allocate_node_data(struct_def->size, struct_def->alignment)}
+		, children(struct_def->fields.size())
+	{
+		struct_def->lifecycle.default_construct(this->data);
+	}
+
+
+	SnapshotNode::SnapshotNode(FieldDef const* list_field_def, std::byte const* src_list)
+		: struct_def{nullptr}
+		, list_field_def{list_field_def}
+		, data{allocate_node_data(list_field_def->field_info.size, list_field_def->field_info.alignment)}
+		, children{}
+	{
+		if (!list_field_def->field_info.copy_construct(this->data, src_list)) {
+			::operator delete(this->data, std::align_val_t{this->alignment()});
+			this->data = nullptr;
+		}
+	}
+
+
+	SnapshotNode::SnapshotNode(SnapshotNode const& other)
+		: struct_def{other.struct_def}
+		, list_field_def{other.list_field_def}
+		, data{nullptr}
+		, children{other.children}
+	{
+		if (this->struct_def) {
+			// Can't fail, as VersionedObject::create already copied every plain field when building the first node
+			this->data = allocate_node_data(this->size(), this->alignment());
+			this->struct_def->lifecycle.default_construct(this->data);
+			copy_plain_fields(*this->struct_def, this->children, this->data, other.data);
+
+		} else if (other.data) {
+			this->data = allocate_node_data(this->size(), this->alignment());
+			if (!this->list_field_def->field_info.copy_construct(this->data, other.data)) {
+				::operator delete(this->data, std::align_val_t{this->alignment()});
+				this->data = nullptr;
+			}
+		}
+	}
+
+
+	SnapshotNode::~SnapshotNode() {
+		if (!this->data) {
+			return;
+		}
+
+		if (this->struct_def) {
+			this->struct_def->lifecycle.destroy(this->data);
+		} else {
+			this->list_field_def->field_info.destroy(this->data);
+		}
+
+		::operator delete(this->data, std::align_val_t{this->alignment()});
+	}
+
+
+	std::size_t SnapshotNode::size() const {
+		return this->struct_def ? this->struct_def->size : this->list_field_def->field_info.size;
+	}
+
+
+	std::size_t SnapshotNode::alignment() const {
+		return this->struct_def ? this->struct_def->alignment : this->list_field_def->field_info.alignment;
+	}
+
+
+
+	bool Snapshot::materialize(std::byte* dst) const {
+		return materialize_node(*this->root, dst);
+	}
+
+
+	std::optional<FieldRef> resolve_field_path(Kernel const& kernel, Snapshot const& snapshot, std::string_view field_path) {
+		SnapshotNode const* root = snapshot.root.get();
+
+		auto const field_idxs = field_idx_path(kernel, root->struct_def, field_path);
+		if (!field_idxs) {
+			return std::nullopt;
+		}
+
+		auto const resolved = resolve_in_nodes(root, *field_idxs, [] (SnapshotNode const* node, FieldIdx field_idx) {
+			return node->children[field_idx].get();
+		});
+
+		if (!resolved) {
+			return std::nullopt;
+		}
+
+		return FieldRef{resolved->struct_id, resolved->field_def, resolved->field_ptr};
+	}
+
+
+
+	auto VersionedObject::create(Kernel const& kernel, StructRef initial) -> std::optional<VersionedObject> {
+		auto root = build_node(kernel, *initial.struct_def, initial.struct_ptr);
+		if (!root) {
+			return std::nullopt;
+		}
+
+		return VersionedObject {&kernel, std::move(root)};
+	}
+
+
+	void VersionedObject::restore(Snapshot const& snapshot) {
+		// Shares the snapshot's root, which is copied on the next write
+		this->root = std::const_pointer_cast<SnapshotNode>(snapshot.root);
+	}
+
+
+	std::optional<FieldMutRef> VersionedObject::resolve_field_path(std::string_view field_path) {
+		// Checked before copying anything, so a bad path doesn't break sharing with the last snapshot
+		auto const field_idxs = field_idx_path(*this->kernel, this->root->struct_def, field_path);
+		if (!field_idxs) {
+			return std::nullopt;
+		}
+
+		if (this->root.use_count() > 1) {
+			this->root = std::make_shared<SnapshotNode>(*this->root);
+		}
+
+		// Every node on the path is made unique before it's entered. Nodes are only ever created non-const,
+		// so casting away const from an unshared node is safe
+		auto const resolved = resolve_in_nodes(this->root.get(), *field_idxs, [] (SnapshotNode* node, FieldIdx field_idx) {
+			auto& child = node->children[field_idx];
+			if (child.use_count() > 1) {
+				child = std::make_shared<SnapshotNode>(*child);
+			}
+			return const_cast<SnapshotNode*>(child.get());
+		});
+
+		if (!resolved) {
+			return std::nullopt;
+		}
+
+		return FieldMutRef{resolved->struct_id, resolved->field_def, resolved->field_ptr};
+	}
+
+
+	std::optional<FieldRef> VersionedObject::resolve_field_path(std::string_view field_path) const {
+		return property::resolve_field_path(*this->kernel, this->snapshot(), field_path);
+	}
+
+
+
+	auto memory_usage(std::span<Snapshot const> snapshots) -> MemoryUsage {
+		MemoryUsage usage;
+		std::unordered_set<SnapshotNode const*> visited;
+
+		for (auto const& snapshot : snapshots) {
+			add_node_usage(snapshot.root.get(), visited, usage);
+		}
+
+		return usage;
+	}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "property/property.h"
+#include "property/memory_report.h"
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace property {
+
+	// One level of a copy-on-write object.
+	// A struct node holds an instance of its struct, with each nested registered struct and list field held in a
+	// child node instead; the instance's own copies of those fields are left default constructed.
+	// A list node holds a single list object.
+	struct SnapshotNode {
+		SnapshotNode(StructDef const* struct_def);
+		SnapshotNode(FieldDef const* list_field_def, std::byte const* src_list);
+		// Shallow copy: the data is copied, children are shared
+		SnapshotNode(SnapshotNode const& other);
+		~SnapshotNode();
+
+		SnapshotNode& operator=(SnapshotNode const&) = delete;
+
+		// Exactly one of these is set
+		StructDef const* struct_def;
+		FieldDef const* list_field_def;
+
+		// Null if the list couldn't be copied
+		std::byte* data;
+		// Indexed by FieldIdx for struct nodes, null for fields stored in data. Empty for list nodes
+		std::vector<std::shared_ptr<SnapshotNode const>> children;
+
+		std::size_t size() const;
+		std::size_t alignment() const;
+	};
+
+
+	// An immutable version of an object. Copying a snapshot is O(1), and snapshots share every node that
+	// hasn't been written since.
+	struct Snapshot {
+		std::shared_ptr<SnapshotNode const> root;
+
+		StructDef const* struct_def() const { return root->struct_def; }
+
+		// Copies the snapshot's values into a constructed instance of its struct
+		bool materialize(std::byte* dst) const;
+	};
+
+	std::optional<FieldRef> resolve_field_path(Kernel const& kernel, Snapshot const& snapshot, std::string_view field_path);
+
+
+	// The mutable head of a versioned object.
+	// Writes go through resolve_field_path, which first copies every node on the path that's shared with a
+	// snapshot, so each write costs the size of the path rather than the whole object. Nodes are shared without
+	// atomic ownership checks on the write path, so a VersionedObject must only be written by one thread at a time.
+	struct VersionedObject {
+		// Returns nullopt if any field of initial, including those of nested structs, isn't copy assignable, or any
+		// list isn't copy constructible. Copying nodes on write would otherwise silently reset those fields
+		static auto create(Kernel const& kernel, StructRef initial) -> std::optional<VersionedObject>;
+
+		auto snapshot() const -> Snapshot { return Snapshot{root}; }
+		void restore(Snapshot const& snapshot);
+
+		StructDef const* struct_def() const { return root->struct_def; }
+
+		// The returned ref must not be written after the next snapshot() or restore: it points into a node that
+		// the snapshot then shares, so writing through it silently changes that snapshot too. Resolve the path
+		// again instead, which copies the node first.
+		// A path ending at a nested struct refers to that struct's node, so writing it whole only updates the
+		// fields the node stores itself
+		std::optional<FieldMutRef> resolve_field_path(std::string_view field_path);
+		std::optional<FieldRef> resolve_field_path(std::string_view field_path) const;
+
+		Kernel const* kernel;
+
+	private:
+		VersionedObject(Kernel const* kernel, std::shared_ptr<SnapshotNode> root) : kernel{kernel}, root{std::move(root)} {}
+
+		std::shared_ptr<SnapshotNode> root;
+	};
+
+
+	// Node allocations across a set of snapshots, counting each shared node once.
+	// List nodes count the list object, but not its elements.
+	auto memory_usage(std::span<Snapshot const> snapshots) -> MemoryUsage;
+
+} // property
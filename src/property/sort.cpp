@@ -0,0 +1,291 @@
+#include "property/sort.h"
+#include "property/internal/value_access.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace property {
+
+	namespace {
+		constexpr std::uint64_t sign_bit = std::uint64_t{1} << 63;
+
+		std::uint64_t encode_signed(std::int64_t value) {
+			return static_cast<std::uint64_t>(value) ^ sign_bit;
+		}
+
+		// Flips negative floats entirely and positive floats' sign bit, so that the bits order like the values
+		std::uint64_t encode_float(float value) {
+			auto const bits = std::bit_cast<std::uint32_t>(value);
+			return (bits & 0x8000'0000u) ? ~bits : (bits | 0x8000'0000u);
+		}
+
+		// The first 8 bytes of a string, big endian so that integer order matches byte-wise order
+		std::uint64_t string_prefix(std::string_view string) {
+			std::uint64_t prefix = 0;
+			for (std::size_t idx = 0; idx < 8; idx++) {
+				auto const c = idx < string.size() ? static_cast<unsigned char>(string[idx]) : 0;
+				prefix = (prefix << 8) | c;
+			}
+			return prefix;
+		}
+
+
+		// Stable LSD radix sort of keys, permuting order alongside.
+		// Digits where all keys are the same are skipped, so narrow keys only pay for the bytes they use.
+		void radix_sort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& order) {
+			constexpr std::size_t digit_count = 8;
+			auto const count = keys.size();
+
+			std::array<std::array<std::size_t, 256>, digit_count> histograms {};
+			for (auto const key : keys) {
+				for (std::size_t digit = 0; digit < digit_count; digit++) {
+					histograms[digit][(key >> (digit * 8)) & 0xff]++;
+				}
+			}
+
+			std::vector<std::uint64_t> keys_scratch(count);
+			std::vector<std::uint32_t> order_scratch(count);
+
+			for (std::size_t digit = 0; digit < digit_count; digit++) {
+				auto& histogram = histograms[digit];
+				if (std::find(histogram.begin(), histogram.end(), count) != histogram.end()) {
+					continue;
+				}
+
+				std::size_t offset = 0;
+				for (auto& bucket : histogram) {
+					auto const bucket_count = bucket;
+					bucket = offset;
+					offset += bucket_count;
+				}
+
+				for (std::size_t idx = 0; idx < count; idx++) {
+					auto const dst = histogram[(keys[idx] >> (digit * 8)) & 0xff]++;
+					keys_scratch[dst] = keys[idx];
+					order_scratch[dst] = order[idx];
+				}
+
+				keys.swap(keys_scratch);
+				order.swap(order_scratch);
+			}
+		}
+
+
+		auto identity_order(std::size_t count) -> std::vector<std::uint32_t> {
+			std::vector<std::uint32_t> order(count);
+			for (std::size_t idx = 0; idx < count; idx++) {
+				order[idx] = static_cast<std::uint32_t>(idx);
+			}
+			return order;
+		}
+	}
+
+
+	std::uint64_t FieldSortKey::integer_key(std::byte const* struct_ptr) const {
+		auto const field_ptr = struct_ptr + this->path.offset;
+
+		if (this->kind == Kind::Float) {
+			float value;
+			std::memcpy(&value, field_ptr, sizeof value);
+			return encode_float(value);
+		}
+
+		return encode_signed(internal::read_signed(field_ptr, this->size));
+	}
+
+
+	std::string_view FieldSortKey::string_key(std::byte const* struct_ptr) const {
+		return internal::read_string(struct_ptr + this->path.offset);
+	}
+
+
+	auto make_field_sort_key(Kernel const& kernel, StructDef const* struct_def, std::string_view field_path) -> std::optional<FieldSortKey> {
+		auto compiled_path = compile_field_path(kernel, struct_def, field_path);
+		if (!compiled_path || compiled_path->field_def->list_info) {
+			return std::nullopt;
+		}
+
+		auto const& field_info = compiled_path->field_def->field_info;
+		auto const size = static_cast<std::uint32_t>(field_info.size);
+
+		switch (field_info.type_id) {
+			case TypeId::Int: return FieldSortKey{*compiled_path, FieldSortKey::Kind::Signed, size};
+			case TypeId::Float: return FieldSortKey{*compiled_path, FieldSortKey::Kind::Float, size};
+			case TypeId::String: return FieldSortKey{*compiled_path, FieldSortKey::Kind::String, size};
+			default: break;
+		}
+
+		bool const is_enum = kernel.enum_id_from_type_id(field_info.type_id).has_value();
+		if (is_enum && (size == 1 || size == 2 || size == 4 || size == 8)) {
+			return FieldSortKey{*compiled_path, FieldSortKey::Kind::Signed, size};
+		}
+
+		return std::nullopt;
+	}
+
+
+
+	auto sort_by_field(FieldSortKey const& key, StructSpan instances, SortOrder order) -> std::vector<std::uint32_t> {
+		auto const count = instances.count;
+		auto const stride = instances.struct_def->size;
+		auto const flip = order == SortOrder::Descending ? ~std::uint64_t{0} : 0;
+
+		auto permutation = identity_order(count);
+		std::vector<std::uint64_t> keys(count);
+
+		if (!key.is_string()) {
+			for (std::size_t idx = 0; idx < count; idx++) {
+				keys[idx] = key.integer_key(instances.data + idx * stride) ^ flip;
+			}
+
+			radix_sort(keys, permutation);
+			return permutation;
+		}
+
+		// Strings are radix sorted by their first 8 bytes, then runs sharing a prefix are compared in full
+		std::vector<std::string_view> strings(count);
+		for (std::size_t idx = 0; idx < count; idx++) {
+			strings[idx] = key.string_key(instances.data + idx * stride);
+			keys[idx] = string_prefix(strings[idx]) ^ flip;
+		}
+
+		radix_sort(keys, permutation);
+
+		auto const compare = [&strings, order] (std::uint32_t lhs, std::uint32_t rhs) {
+			return order == SortOrder::Ascending ? strings[lhs] < strings[rhs] : strings[rhs] < strings[lhs];
+		};
+
+		for (std::size_t run_begin = 0; run_begin < count;) {
+			auto run_end = run_begin + 1;
+			while (run_end < count && keys[run_end] == keys[run_begin]) {
+				run_end++;
+			}
+
+			if (run_end - run_begin > 1) {
+				std::stable_sort(permutation.begin() + run_begin, permutation.begin() + run_end, compare);
+			}
+
+			run_begin = run_end;
+		}
+
+		return permutation;
+	}
+
+
+	auto sort_by_field(Kernel const& kernel, StructSpan instances, std::string_view field_path, SortOrder order)
+		-> std::optional<std::vector<std::uint32_t>>
+	{
+		auto const key = make_field_sort_key(kernel, instances.struct_def, field_path);
+		if (!key) {
+			return std::nullopt;
+		}
+
+		return sort_by_field(*key, instances, order);
+	}
+
+
+
+	void SortedFieldIndex::build(StructSpan instances) {
+		auto const count = instances.count;
+		auto const stride = instances.struct_def->size;
+
+		this->integer_keys.clear();
+		this->string_keys.clear();
+
+		for (std::size_t idx = 0; idx < count; idx++) {
+			this->set_key(static_cast<std::uint32_t>(idx), instances.data + idx * stride);
+		}
+
+		this->order = sort_by_field(this->key, instances);
+	}
+
+
+	void SortedFieldIndex::append(std::byte const* struct_ptr) {
+		auto const instance_idx = static_cast<std::uint32_t>(this->order.size());
+		this->set_key(instance_idx, struct_ptr);
+
+		auto const insert_it = std::lower_bound(this->order.begin(), this->order.end(), instance_idx,
+			[this] (std::uint32_t lhs, std::uint32_t rhs) { return this->less(lhs, rhs); });
+		this->order.insert(insert_it, instance_idx);
+	}
+
+
+	void SortedFieldIndex::update(std::uint32_t instance_idx, std::byte const* struct_ptr) {
+		auto const less = [this] (std::uint32_t lhs, std::uint32_t rhs) { return this->less(lhs, rhs); };
+
+		// Found using the old key, which is still stored
+		auto const old_it = std::lower_bound(this->order.begin(), this->order.end(), instance_idx, less);
+		this->set_key(instance_idx, struct_ptr);
+
+		// Shift the instance towards its new position, searching only the entries either side of it
+		auto const upper_it = std::lower_bound(old_it + 1, this->order.end(), instance_idx, less);
+		if (upper_it != old_it + 1) {
+			std::rotate(old_it, old_it + 1, upper_it);
+			return;
+		}
+
+		auto const lower_it = std::lower_bound(this->order.begin(), old_it, instance_idx, less);
+		std::rotate(lower_it, old_it, old_it + 1);
+	}
+
+
+	auto SortedFieldIndex::int_range(std::int64_t min, std::int64_t max) const -> std::span<std::uint32_t const> {
+		return this->integer_range(encode_signed(min), encode_signed(max));
+	}
+
+
+	auto SortedFieldIndex::float_range(float min, float max) const -> std::span<std::uint32_t const> {
+		return this->integer_range(encode_float(min), encode_float(max));
+	}
+
+
+	auto SortedFieldIndex::string_range(std::string_view min, std::string_view max) const -> std::span<std::uint32_t const> {
+		auto const begin = std::lower_bound(this->order.begin(), this->order.end(), min,
+			[this] (std::uint32_t idx, std::string_view value) { return this->string_keys[idx] < value; });
+		auto const end = std::upper_bound(begin, this->order.end(), max,
+			[this] (std::string_view value, std::uint32_t idx) { return value < this->string_keys[idx]; });
+
+		return std::span{begin, end};
+	}
+
+
+	auto SortedFieldIndex::integer_range(std::uint64_t min, std::uint64_t max) const -> std::span<std::uint32_t const> {
+		auto const begin = std::lower_bound(this->order.begin(), this->order.end(), min,
+			[this] (std::uint32_t idx, std::uint64_t value) { return this->integer_keys[idx] < value; });
+		auto const end = std::upper_bound(begin, this->order.end(), max,
+			[this] (std::uint64_t value, std::uint32_t idx) { return value < this->integer_keys[idx]; });
+
+		return std::span{begin, end};
+	}
+
+
+	bool SortedFieldIndex::less(std::uint32_t lhs, std::uint32_t rhs) const {
+		if (this->key.is_string()) {
+			auto const& lhs_key = this->string_keys[lhs];
+			auto const& rhs_key = this->string_keys[rhs];
+			return lhs_key < rhs_key || (lhs_key == rhs_key && lhs < rhs);
+		}
+
+		auto const lhs_key = this->integer_keys[lhs];
+		auto const rhs_key = this->integer_keys[rhs];
+		return lhs_key < rhs_key || (lhs_key == rhs_key && lhs < rhs);
+	}
+
+
+	void SortedFieldIndex::set_key(std::uint32_t instance_idx, std::byte const* struct_ptr) {
+		if (this->key.is_string()) {
+			if (instance_idx >= this->string_keys.size()) {
+				this->string_keys.resize(instance_idx + 1);
+			}
+			this->string_keys[instance_idx] = this->key.string_key(struct_ptr);
+		} else {
+			if (instance_idx >= this->integer_keys.size()) {
+				this->integer_keys.resize(instance_idx + 1);
+			}
+			this->integer_keys[instance_idx] = this->key.integer_key(struct_ptr);
+		}
+	}
+
+}
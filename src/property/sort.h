@@ -0,0 +1,86 @@
+#pragma once
+
+#include "property/property.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace property {
+
+	enum class SortOrder {
+		Ascending,
+		Descending,
+	};
+
+
+	// A field path compiled for key extraction.
+	// Int, float and enum fields map to unsigned integers with the same ordering, so they can be radix sorted.
+	// String fields are ordered by byte-wise comparison.
+	struct FieldSortKey {
+		enum class Kind {
+			Signed,
+			Float,
+			String,
+		};
+
+		CompiledFieldPath path;
+		Kind kind;
+		std::uint32_t size;
+
+		bool is_string() const { return kind == Kind::String; }
+
+		std::uint64_t integer_key(std::byte const* struct_ptr) const;
+		std::string_view string_key(std::byte const* struct_ptr) const;
+	};
+
+	// Returns nullopt if the path doesn't resolve, or resolves to a struct, list or other unsortable field
+	auto make_field_sort_key(Kernel const& kernel, StructDef const* struct_def, std::string_view field_path) -> std::optional<FieldSortKey>;
+
+
+	// Stable sort of a span's instances by a field's value, without moving them.
+	// Returns the permutation, i.e., the index of the instance at each sorted position.
+	auto sort_by_field(FieldSortKey const& key, StructSpan instances, SortOrder order = SortOrder::Ascending) -> std::vector<std::uint32_t>;
+	auto sort_by_field(Kernel const& kernel, StructSpan instances, std::string_view field_path, SortOrder order = SortOrder::Ascending)
+		-> std::optional<std::vector<std::uint32_t>>;
+
+
+	// Instance indices kept in ascending order of a field's value.
+	// Keys are copied out of the instances, so an instance must be updated after its field changes for the
+	// index to stay sorted. Equal keys are ordered by instance index.
+	struct SortedFieldIndex {
+		SortedFieldIndex(FieldSortKey key) : key{std::move(key)} {}
+
+		// Rebuilds the index for all instances
+		void build(StructSpan instances);
+
+		// Adds the instance with the next index, i.e., size()
+		void append(std::byte const* struct_ptr);
+		// Moves an instance to its new position after its key changed
+		void update(std::uint32_t instance_idx, std::byte const* struct_ptr);
+
+		// Instance indices with keys in [min, max], in sorted order. Each must match the key kind
+		auto int_range(std::int64_t min, std::int64_t max) const -> std::span<std::uint32_t const>;
+		auto float_range(float min, float max) const -> std::span<std::uint32_t const>;
+		auto string_range(std::string_view min, std::string_view max) const -> std::span<std::uint32_t const>;
+
+		auto sorted() const -> std::span<std::uint32_t const> { return order; }
+		auto size() const { return order.size(); }
+
+		FieldSortKey key;
+
+	private:
+		bool less(std::uint32_t lhs, std::uint32_t rhs) const;
+		auto integer_range(std::uint64_t min, std::uint64_t max) const -> std::span<std::uint32_t const>;
+		void set_key(std::uint32_t instance_idx, std::byte const* struct_ptr);
+
+		std::vector<std::uint32_t> order;
+		// Per instance keys, only one of which is used depending on the key kind
+		std::vector<std::uint64_t> integer_keys;
+		std::vector<std::string> string_keys;
+	};
+
+} // property
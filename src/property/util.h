@@ -16,6 +16,10 @@ template<class S>
 concept StandardLayout = std::is_standard_layout_v<S>;
 template<class S>
 concept Enum = std::is_enum_v<S>;
+template<class S>
+concept RegistrableStruct = StandardLayout<S>
+	&& std::is_default_constructible_v<S>
+	&& std::is_destructible_v<S>;
 
 template <class From, class To>
 concept convertible_to =